@@ -0,0 +1,142 @@
+
+// ****************************************************************************
+// File: AddrIndex.cpp
+// Desc: Address class index for the vftable checks
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Main.h"
+#include "AddrIndex.h"
+#include <algorithm>
+
+// Code segment intervals, sorted and coalesced
+static qvector<ea_t> codeStarts, codeEnds;
+
+// Slot classes of a scan segment, two bits per 4 byte slot, filled in a block at the time on first use
+struct SLOTMAP
+{
+	ea_t start, end;
+	qvector<BYTE> bits;
+	qvector<UINT> built;	// One bit per block
+};
+static qvector<SLOTMAP> slotMaps;
+static SLOTMAP *lastMap = NULL;
+
+static const UINT SLOT_SIZE = sizeof(UINT);
+static const UINT SLOTS_PER_BYTE = 4;
+// A block's worth of flag reads covers a typical vftable and its neighbors
+static const UINT SLOTS_PER_BLOCK = 128;
+
+void AddrIndex::clear()
+{
+	codeStarts.clear();
+	codeEnds.clear();
+	slotMaps.clear();
+	lastMap = NULL;
+}
+
+void AddrIndex::build(const qvector<segment_t *> &segs)
+{
+	clear();
+
+	int segCount = get_segm_qty();
+	for (int i = 0; i < segCount; i++)
+	{
+		if (segment_t *seg = getnseg(i))
+		{
+			if (seg->type != SEG_CODE)
+				continue;
+
+			if (!codeEnds.empty() && (codeEnds.back() == seg->start_ea))
+				codeEnds.back() = seg->end_ea;
+			else
+			{
+				codeStarts.push_back(seg->start_ea);
+				codeEnds.push_back(seg->end_ea);
+			}
+		}
+	}
+
+	slotMaps.resize(segs.size());
+	for (size_t i = 0; i < segs.size(); i++)
+	{
+		SLOTMAP &map = slotMaps[i];
+		map.start = segs[i]->start_ea;
+		map.end   = segs[i]->end_ea;
+	}
+	std::sort(slotMaps.begin(), slotMaps.end(), [](const SLOTMAP &a, const SLOTMAP &b) { return(a.start < b.start); });
+}
+
+BOOL AddrIndex::isCode(ea_t ea)
+{
+	size_t count = codeStarts.size();
+	if (count == 0)
+		return(FALSE);
+
+	// Branch free search for the last interval starting at or below the address
+	const ea_t *base = codeStarts.begin();
+	while (count > 1)
+	{
+		size_t half = (count / 2);
+		base = ((base[half] <= ea) ? (base + half) : base);
+		count -= half;
+	}
+
+	size_t i = (size_t) (base - codeStarts.begin());
+	return((BOOL) ((codeStarts[i] <= ea) & (ea < codeEnds[i])));
+}
+
+static inline BYTE slotFromFlags(flags_t flags)
+{
+	BYTE slot = 0;
+	if (isEa(flags) || is_unknown(flags))
+		slot |= AddrIndex::SLOT_EA;
+	if (has_xref(flags))
+		slot |= AddrIndex::SLOT_XREF;
+	return(slot);
+}
+
+// Read the slot flags of one block of a segment
+static void buildSlotBlock(SLOTMAP &map, size_t block)
+{
+	size_t count = (size_t) ((map.end - map.start) / SLOT_SIZE);
+	if (map.bits.empty())
+	{
+		map.bits.resize(((count + (SLOTS_PER_BYTE - 1)) / SLOTS_PER_BYTE), 0);
+		map.built.resize(((((count + (SLOTS_PER_BLOCK - 1)) / SLOTS_PER_BLOCK) + 31) / 32), 0);
+	}
+
+	size_t end = ((block + 1) * SLOTS_PER_BLOCK);
+	if (end > count)
+		end = count;
+	for (size_t i = (block * SLOTS_PER_BLOCK); i < end; i++)
+	{
+		BYTE slot = slotFromFlags(get_flags(map.start + (ea_t) (i * SLOT_SIZE)));
+		map.bits[i / SLOTS_PER_BYTE] |= (slot << ((i % SLOTS_PER_BYTE) * 2));
+	}
+	map.built[block >> 5] |= (1u << (block & 31));
+}
+
+BYTE AddrIndex::getSlot(ea_t ea)
+{
+	// Same segment as last time is by far the common case
+	SLOTMAP *map = lastMap;
+	if (!(map && (ea >= map->start) && (ea < map->end)))
+	{
+		map = NULL;
+		qvector<SLOTMAP>::iterator it = std::upper_bound(slotMaps.begin(), slotMaps.end(), ea, [](ea_t a, const SLOTMAP &b) { return(a < b.start); });
+		if ((it != slotMaps.begin()) && (ea < (it - 1)->end))
+			map = lastMap = (it - 1);
+	}
+
+	// Unaligned or outside the scan segments
+	ea_t offset = (map ? (ea - map->start) : 0);
+	if (!map || (offset & (SLOT_SIZE - 1)) || ((offset / SLOT_SIZE) >= ((map->end - map->start) / SLOT_SIZE)))
+		return(slotFromFlags(get_flags(ea)));
+
+	size_t i = (size_t) (offset / SLOT_SIZE);
+	size_t block = (i / SLOTS_PER_BLOCK);
+	if (map->built.empty() || !(map->built[block >> 5] & (1u << (block & 31))))
+		buildSlotBlock(*map, block);
+	return((map->bits[i / SLOTS_PER_BYTE] >> ((i % SLOTS_PER_BYTE) * 2)) & (SLOT_EA | SLOT_XREF));
+}
@@ -0,0 +1,27 @@
+
+// ****************************************************************************
+// File: AddrIndex.h
+// Desc: Address class index for the vftable checks
+//
+// ****************************************************************************
+#pragma once
+
+namespace AddrIndex
+{
+	// Slot class bits
+	const BYTE SLOT_EA   = 0x01;	// ea_t sized data or unknown bytes
+	const BYTE SLOT_XREF = 0x02;	// Has an IDA cross reference
+
+	// Build from the current segments and the (snapshotted) scan segments, once per run.
+	// Only cheap interval work up front, slot classes are filled in a small block at the time on first use.
+	void build(const qvector<segment_t *> &segs);
+	void clear();
+
+	// Address is inside a code segment. Safe on the worker threads
+	BOOL isCode(ea_t ea);
+
+	// Slot class bits for a 4 byte aligned address in a scan segment, else straight from the flags.
+	// The flags are read once per block, so only valid while the IDB isn't being edited (the edit queue is active).
+	// Main thread only
+	BYTE getSlot(ea_t ea);
+}
@@ -0,0 +1,62 @@
+
+// ****************************************************************************
+// File: Arena.cpp
+// Desc: Bump allocator for run scoped data
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Arena.h"
+
+static const size_t BLOCK_SIZE = (64 * 1024);
+static const size_t ALIGNMENT = sizeof(void *);
+
+void *arena::alloc(size_t size)
+{
+	size = ((size + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1));
+	if (size > left)
+	{
+		// Big ones get their own block, the current one stays in use
+		if (size > (BLOCK_SIZE / 4))
+		{
+			BYTE *block = (BYTE *) qalloc(size);
+			if (!block)
+				return(NULL);
+			blocks.push_back(block);
+			used += size;
+			return(block);
+		}
+
+		BYTE *block = (BYTE *) qalloc(BLOCK_SIZE);
+		if (!block)
+			return(NULL);
+		blocks.push_back(block);
+		cur = block;
+		left = BLOCK_SIZE;
+	}
+
+	BYTE *result = cur;
+	cur  += size;
+	left -= size;
+	used += size;
+	return(result);
+}
+
+LPSTR arena::addString(LPCSTR str, size_t len)
+{
+	LPSTR result = (LPSTR) alloc(len + 1);
+	if (result)
+	{
+		memcpy(result, str, len);
+		result[len] = 0;
+	}
+	return(result);
+}
+
+void arena::clear()
+{
+	for (size_t i = 0; i < blocks.size(); i++)
+		qfree(blocks[i]);
+	blocks.clear();
+	cur = NULL;
+	left = used = 0;
+}
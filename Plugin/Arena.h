@@ -0,0 +1,33 @@
+
+// ****************************************************************************
+// File: Arena.h
+// Desc: Bump allocator for run scoped data
+//
+// ****************************************************************************
+#pragma once
+
+// Allocations are carved out of large blocks and only freed all together.
+// Blocks never move, so pointers stay valid until clear().
+class arena
+{
+public:
+	arena() : cur(NULL), left(0), used(0) {}
+	~arena() { clear(); }
+
+	void *alloc(size_t size);
+	// Copy of 'len' chars of 'str' plus a terminator
+	LPSTR addString(LPCSTR str, size_t len);
+	void clear();
+
+	// Bytes handed out
+	size_t getSize() const { return(used); }
+
+private:
+	qvector<BYTE *> blocks;
+	BYTE *cur;
+	size_t left, used;
+
+	// No copies
+	arena(const arena &);
+	arena &operator=(const arena &);
+};
@@ -0,0 +1,411 @@
+
+// ****************************************************************************
+// File: Demangle.cpp
+// Desc: Native MSVC type name demangler
+//
+// ****************************************************************************
+#include "Demangle.h"
+#include <string.h>
+
+// Most names a back reference table holds
+static const int MAX_NAMES = 10;
+// Most fragments of one scoped name
+static const int MAX_FRAGMENTS = 32;
+// Deepest type nesting followed
+static const int MAX_DEPTH = 32;
+
+// Back reference table, the encoded fragments in the order they were first seen, with where their output is
+struct NAMES
+{
+	const char *at[MAX_NAMES];
+	size_t len[MAX_NAMES];
+	size_t outAt[MAX_NAMES], outLen[MAX_NAMES];
+	int count;
+};
+
+// Output into the caller's buffer. Can be turned off to just step over encoding.
+struct OUTBUF
+{
+	char *start, *p, *end;
+	bool on, overflow;
+	char last;
+
+	inline void put(const char *str, size_t len)
+	{
+		if (!on || (len == 0))
+			return;
+		if ((size_t) (end - p) <= len)
+		{
+			overflow = true;
+			return;
+		}
+		memcpy(p, str, len);
+		p += len;
+		last = str[len - 1];
+	}
+	inline void put(const char *str) { put(str, strlen(str)); }
+};
+
+struct STATE
+{
+	const char *p;
+	OUTBUF out;
+	NAMES *names;
+	int depth;
+};
+
+static bool parseType(STATE &s);
+
+static void memorize(NAMES &names, const char *at, size_t len, size_t outAt, size_t outLen)
+{
+	for (int i = 0; i < names.count; i++)
+	{
+		if ((names.len[i] == len) && (memcmp(names.at[i], at, len) == 0))
+			return;
+	}
+	if (names.count < MAX_NAMES)
+	{
+		names.at[names.count] = at;
+		names.len[names.count] = len;
+		names.outAt[names.count] = outAt;
+		names.outLen[names.count] = outLen;
+		names.count++;
+	}
+}
+
+static void reverse(char *p, char *end)
+{
+	while (p < --end)
+	{
+		char c = *p;
+		*p++ = *end;
+		*end = c;
+	}
+}
+
+// Simple name up to its '@'
+static bool parseIdentifier(STATE &s)
+{
+	const char *start = s.p;
+	while (*s.p && (*s.p != '@'))
+		s.p++;
+	if (!*s.p || (s.p == start))
+		return(false);
+	s.out.put(start, (size_t) (s.p - start));
+	s.p++;
+	return(true);
+}
+
+// Template instance "?$name@args@", the arguments having their own back reference table
+static bool parseTemplate(STATE &s)
+{
+	if (++s.depth > MAX_DEPTH)
+		return(false);
+
+	NAMES inner;
+	inner.count = 0;
+	NAMES *outer = s.names;
+	s.names = &inner;
+
+	const char *name = s.p;
+	char *nameOut = s.out.p;
+	if (!parseIdentifier(s))
+		return(false);
+	memorize(inner, name, (size_t) (s.p - name), (size_t) (nameOut - s.out.start), (size_t) (s.out.p - nameOut));
+
+	s.out.put("<", 1);
+	for (bool first = true; *s.p != '@'; first = false)
+	{
+		if (!*s.p)
+			return(false);
+		if (!first)
+			s.out.put(",", 1);
+		if (!parseType(s))
+			return(false);
+	}
+	s.p++;
+
+	// "> >" not ">>"
+	if (s.out.on && (s.out.last == '>'))
+		s.out.put(" ", 1);
+	s.out.put(">", 1);
+
+	s.names = outer;
+	s.depth--;
+	return(true);
+}
+
+// One scoped name fragment, not a back reference
+static bool parseFragment(STATE &s)
+{
+	if (s.p[0] == '?')
+	{
+		if (s.p[1] == '$')
+		{
+			s.p += 2;
+			return(parseTemplate(s));
+		}
+		else
+		if ((s.p[1] == 'A') && (s.p[2] == '0') && (s.p[3] == 'x'))
+		{
+			// "?A0x12345678@"
+			bool on = s.out.on;
+			s.out.on = false;
+			s.p += 2;
+			bool result = parseIdentifier(s);
+			s.out.on = on;
+			s.out.put("`anonymous namespace'");
+			return(result);
+		}
+		return(false);
+	}
+	return(parseIdentifier(s));
+}
+
+// Scoped name, encoded innermost first up to a closing '@', output outermost first.
+// Each fragment is parsed once into the output in encoded order, then the fragment order is reversed in place.
+static bool parseQualifiedName(STATE &s)
+{
+	size_t start = (size_t) (s.out.p - s.out.start);
+	int firstName = s.names->count;
+	size_t lengths[MAX_FRAGMENTS];
+	int count = 0;
+	while (*s.p != '@')
+	{
+		if (!*s.p || (count == MAX_FRAGMENTS))
+			return(false);
+		if (count)
+			s.out.put("::", 2);
+
+		char *from = s.out.p;
+		if ((*s.p >= '0') && (*s.p <= '9'))
+		{
+			// Copy of an earlier fragment's output
+			int index = (*s.p - '0');
+			if (index >= s.names->count)
+				return(false);
+			s.out.put((s.out.start + s.names->outAt[index]), s.names->outLen[index]);
+			s.p++;
+		}
+		else
+		{
+			const char *at = s.p;
+			if (!parseFragment(s))
+				return(false);
+			memorize(*s.names, at, (size_t) (s.p - at), (size_t) (from - s.out.start), (size_t) (s.out.p - from));
+		}
+
+		// Spans are only good while all of the output is there
+		if (s.out.overflow)
+			return(false);
+		lengths[count++] = (size_t) (s.out.p - from);
+	}
+	s.p++;
+	if (count == 0)
+		return(false);
+
+	// "a::b::c" to "c::b::a": reverse the whole span, then each fragment back
+	char *begin = (s.out.start + start);
+	reverse(begin, s.out.p);
+	char *p = begin;
+	for (int i = (count - 1); i >= 0; i--)
+	{
+		reverse(p, (p + lengths[i]));
+		p += (lengths[i] + 2);
+	}
+	s.out.last = s.out.p[-1];
+
+	// The fragments this name added to the back reference table moved with it
+	size_t end = (size_t) (s.out.p - s.out.start);
+	for (int i = firstName; i < s.names->count; i++)
+		s.names->outAt[i] = ((start + end) - (s.names->outAt[i] + s.names->outLen[i]));
+	return(true);
+}
+
+// Encoded integer: '0'..'9' for 1..10, else hex 'A'..'P' digits closed by a '@'; '?' prefix for negatives
+static bool parseNumber(STATE &s)
+{
+	bool negative = false;
+	if (*s.p == '?')
+	{
+		negative = true;
+		s.p++;
+	}
+
+	unsigned long long value = 0;
+	if ((*s.p >= '0') && (*s.p <= '9'))
+		value = (unsigned long long) ((*s.p++ - '0') + 1);
+	else
+	{
+		int digits = 0;
+		for (; (*s.p >= 'A') && (*s.p <= 'P'); s.p++, digits++)
+		{
+			if (digits == 16)
+				return(false);
+			value = ((value << 4) | (unsigned long long) (*s.p - 'A'));
+		}
+		if ((*s.p != '@') || (digits == 0))
+			return(false);
+		s.p++;
+	}
+
+	char buffer[24];
+	char *p = &buffer[sizeof(buffer)];
+	do
+	{
+		*--p = (char) ('0' + (value % 10));
+		value /= 10;
+	} while (value);
+	if (negative)
+		*--p = '-';
+	s.out.put(p, (size_t) (&buffer[sizeof(buffer)] - p));
+	return(true);
+}
+
+static const char *const basicTypes[] =
+{
+	"signed char", "char", "unsigned char", "short", "unsigned short", "int", "unsigned int", "long", "unsigned long", NULL, "float", "double", "long double"
+};
+static const char *const extendedTypes[] =
+{
+	"__int8", "unsigned __int8", "__int16", "unsigned __int16", "__int32", "unsigned __int32", "__int64", "unsigned __int64", NULL, NULL, "bool"
+};
+static const char *const cvNames[] = { "", " const", " volatile", " const volatile" };
+
+static bool parseType(STATE &s)
+{
+	char c = *s.p;
+
+	// 'C' signed char .. 'O' long double
+	if ((c >= 'C') && (c <= 'O') && basicTypes[c - 'C'])
+	{
+		s.p++;
+		s.out.put(basicTypes[c - 'C']);
+		return(true);
+	}
+
+	switch (c)
+	{
+		case 'X':
+		s.p++;
+		s.out.put("void", 4);
+		return(true);
+
+		// '_D' __int8 .. '_N' bool, '_W' wchar_t
+		case '_':
+		c = s.p[1];
+		if ((c >= 'D') && (c <= 'N') && extendedTypes[c - 'D'])
+		{
+			s.p += 2;
+			s.out.put(extendedTypes[c - 'D']);
+			return(true);
+		}
+		else
+		if (c == 'W')
+		{
+			s.p += 2;
+			s.out.put("wchar_t", 7);
+			return(true);
+		}
+		return(false);
+
+		// class, struct, union, then enum
+		case 'V': case 'U': case 'T':
+		s.p++;
+		return(parseQualifiedName(s));
+
+		case 'W':
+		if (s.p[1] != '4')
+			return(false);
+		s.p += 2;
+		return(parseQualifiedName(s));
+
+		// Pointer, const/volatile pointer, reference, volatile reference
+		case 'P': case 'Q': case 'R': case 'S': case 'A': case 'B':
+		{
+			// The __ptr64 forms are left to the CRT
+			char cv = s.p[1];
+			if ((cv < 'A') || (cv > 'D'))
+				return(false);
+			s.p += 2;
+			if (++s.depth > MAX_DEPTH)
+				return(false);
+			if (!parseType(s))
+				return(false);
+			s.depth--;
+
+			s.out.put(cvNames[cv - 'A']);
+			s.out.put((((c == 'A') || (c == 'B')) ? " &" : " *"), 2);
+			switch (c)
+			{
+				case 'Q': s.out.put(cvNames[1]); break;
+				case 'R': case 'B': s.out.put(cvNames[2]); break;
+				case 'S': s.out.put(cvNames[3]); break;
+			};
+			return(true);
+		}
+
+		// Integer template argument
+		case '$':
+		if (s.p[1] != '0')
+			return(false);
+		s.p += 2;
+		return(parseNumber(s));
+	};
+
+	return(false);
+}
+
+size_t Demangle::typeName(const char *mangled, char *out, size_t outSize)
+{
+	if (outSize == 0)
+		return(0);
+	out[0] = 0;
+
+	NAMES names;
+	names.count = 0;
+	STATE s;
+	s.p = mangled;
+	s.out.start = s.out.p = out;
+	s.out.end = (out + outSize);
+	s.out.on = true;
+	s.out.overflow = false;
+	s.out.last = 0;
+	s.names = &names;
+	s.depth = 0;
+
+	// "?A" then the class, struct, union or enum type, else a plain type like "H" or "PAD"
+	bool result;
+	if ((mangled[0] == '?') && (mangled[1] == 'A'))
+	{
+		switch (mangled[2])
+		{
+			case 'V': case 'U': case 'T':
+			s.p += 3;
+			result = parseQualifiedName(s);
+			break;
+
+			case 'W':
+			if (mangled[3] != '4')
+				return(0);
+			s.p += 4;
+			result = parseQualifiedName(s);
+			break;
+
+			default:
+			return(0);
+		};
+	}
+	else
+		result = parseType(s);
+
+	// Has to be the whole string
+	if (!result || s.out.overflow || (*s.p != 0) || (s.out.p == out))
+	{
+		out[0] = 0;
+		return(0);
+	}
+
+	*s.out.p = 0;
+	return((size_t) (s.out.p - out));
+}
@@ -0,0 +1,19 @@
+
+// ****************************************************************************
+// File: Demangle.h
+// Desc: Native MSVC type name demangler
+//
+// ****************************************************************************
+#pragma once
+#include <stddef.h>
+
+// Self-contained, no Windows, IDA or CRT undecorator dependencies, so it also builds off Windows
+namespace Demangle
+{
+	// Undecorate a type descriptor name, less the leading '.', like "?AV?$vector@HV?$allocator@H@std@@@std@@",
+	// into 'out' as __unDName() does with (UNDNAME_32_BIT_DECODE | UNDNAME_TYPE_ONLY | UNDNAME_NO_ECSU).
+	// Covers namespaces, anonymous namespaces, back references and templates with the common argument types.
+	// No heap allocation.
+	// Returns the output length, or zero if the name uses encoding not covered here or doesn't fit 'outSize'
+	size_t typeName(const char *mangled, char *out, size_t outSize);
+}
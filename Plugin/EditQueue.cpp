@@ -0,0 +1,118 @@
+
+// ****************************************************************************
+// File: EditQueue.cpp
+// Desc: Deferred, address ordered IDB writes
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "EditQueue.h"
+#include <WaitBoxEx.h>
+#include <algorithm>
+#include <vector>
+
+struct QUEUED
+{
+	ea_t ea;
+	EditQueue::EDIT edit;
+};
+
+// std::vector since std::function isn't safe to relocate the way qvector does
+static std::vector<QUEUED> queue;
+static BOOL active = FALSE;
+
+// Commit mode state
+static qvector<range_t> touched;
+static BOOL suspended = FALSE;
+static bool autoWasEnabled = true;
+
+void EditQueue::begin()
+{
+	queue.clear();
+	active = TRUE;
+}
+
+BOOL EditQueue::isActive() { return(active); }
+size_t EditQueue::size() { return(queue.size()); }
+
+void EditQueue::add(ea_t ea, EDIT edit)
+{
+	QUEUED q = { ea, edit };
+	queue.push_back(q);
+}
+
+BOOL EditQueue::apply()
+{
+	// Edits run for real from here
+	active = FALSE;
+	if (!suspended)
+	{
+		autoWasEnabled = enable_auto(false);
+		suspended = TRUE;
+	}
+
+	std::stable_sort(queue.begin(), queue.end(), [](const QUEUED &a, const QUEUED &b) { return(a.ea < b.ea); });
+
+	BOOL aborted = FALSE;
+	for (size_t i = 0; i < queue.size(); i++)
+	{
+		queue[i].edit();
+
+		if (WaitBox::isUpdateTime())
+		{
+			if (WaitBox::updateAndCancelCheck())
+			{
+				aborted = TRUE;
+				break;
+			}
+		}
+	}
+
+	std::vector<QUEUED>().swap(queue);
+	return(aborted);
+}
+
+void EditQueue::clear()
+{
+	active = FALSE;
+	std::vector<QUEUED>().swap(queue);
+
+	// Never leave auto-analysis off, as on abort
+	resume();
+}
+
+BOOL EditQueue::isSuspended() { return(suspended); }
+BOOL EditQueue::wasAutoEnabled() { return(autoWasEnabled); }
+
+void EditQueue::touch(ea_t start, ea_t end)
+{
+	if (suspended && (end > start))
+		touched.push_back(range_t(start, end));
+}
+
+size_t EditQueue::resume()
+{
+	if (!suspended)
+		return(0);
+	suspended = FALSE;
+	enable_auto(autoWasEnabled);
+
+	// Coalesce overlapping and adjacent ranges
+	std::sort(touched.begin(), touched.end(), [](const range_t &a, const range_t &b) { return(a.start_ea < b.start_ea); });
+
+	size_t count = 0;
+	for (size_t i = 0; i < touched.size();)
+	{
+		ea_t start = touched[i].start_ea, end = touched[i].end_ea;
+		for (++i; (i < touched.size()) && (touched[i].start_ea <= end); ++i)
+		{
+			if (touched[i].end_ea > end)
+				end = touched[i].end_ea;
+		}
+
+		plan_range(start, end);
+		count++;
+	}
+
+	touched.clear();
+	return(count);
+}
@@ -0,0 +1,41 @@
+
+// ****************************************************************************
+// File: EditQueue.h
+// Desc: Deferred, address ordered IDB writes
+//
+// ****************************************************************************
+#pragma once
+#include <functional>
+
+namespace EditQueue
+{
+	// A single IDB mutation, applied as-is at commit time
+	typedef std::function<void()> EDIT;
+
+	// While active the IDB write helpers queue their edits instead of applying them,
+	// so analysis runs with no mutation of the database
+	void begin();
+	BOOL isActive();
+	void add(ea_t ea, EDIT edit);
+	size_t size();
+
+	// Apply the queued edits in address order in one pass, keeping the queued order of edits at
+	// the same address, then end the queue.
+	// IDA's auto-analysis is turned off here and stays off until resume(), so the edits don't each
+	// wake it up and queue their own reanalysis.
+	// Returns TRUE if aborted, the rest of the edits are dropped
+	BOOL apply();
+	void clear();
+
+	// Record an address range [start, end) an edit changed while auto-analysis is suspended
+	void touch(ea_t start, ea_t end);
+	BOOL isSuspended();
+
+	// Restore auto-analysis to the state apply() found it in and plan the touched ranges, one per
+	// contiguous range.
+	// Returns the range count
+	size_t resume();
+
+	// Auto-analysis state saved by apply(), TRUE if it was on
+	BOOL wasAutoEnabled();
+}
@@ -0,0 +1,112 @@
+
+// ****************************************************************************
+// File: Intern.cpp
+// Desc: Interned string table
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Intern.h"
+#include "Arena.h"
+
+static const UINT MIN_CAPACITY = 1024;
+static const UINT EMPTY_SLOT = 0xFFFFFFFF;
+// Zero padded, as callers can look past the start of a short name for its "?AV" type tag
+static const char emptyString[8] = { 0 };
+
+// Strings by id, in the arena
+static qvector<LPCSTR> strings;
+static qvector<UINT> lengths;
+static arena storage;
+// Open addressing set of ids, with their hashes alongside
+static qvector<Intern::ID> slots;
+static qvector<UINT> slotHashes;
+
+// FNV-1a
+static UINT hashString(LPCSTR str, size_t len)
+{
+	UINT hash = 2166136261;
+	for (size_t i = 0; i < len; i++)
+		hash = ((hash ^ (BYTE) str[i]) * 16777619);
+	return(hash);
+}
+
+// Slot index holding the string, or the empty one it would go in
+static UINT findSlot(LPCSTR str, size_t len, UINT hash)
+{
+	UINT mask = ((UINT) slots.size() - 1);
+	for (UINT i = (hash & mask);; i = ((i + 1) & mask))
+	{
+		Intern::ID id = slots[i];
+		if (id == EMPTY_SLOT)
+			return(i);
+		if ((slotHashes[i] == hash) && (lengths[id] == len) && (memcmp(strings[id], str, len) == 0))
+			return(i);
+	}
+}
+
+// Double the set, keeping it under 3/4 full
+static void grow()
+{
+	qvector<Intern::ID> oldSlots;
+	qvector<UINT> oldHashes;
+	oldSlots.swap(slots);
+	oldHashes.swap(slotHashes);
+
+	size_t capacity = (oldSlots.empty() ? MIN_CAPACITY : (oldSlots.size() * 2));
+	slots.resize(capacity, EMPTY_SLOT);
+	slotHashes.resize(capacity, 0);
+
+	for (size_t i = 0; i < oldSlots.size(); i++)
+	{
+		Intern::ID id = oldSlots[i];
+		if (id != EMPTY_SLOT)
+		{
+			UINT slot = findSlot(strings[id], lengths[id], oldHashes[i]);
+			slots[slot] = id;
+			slotHashes[slot] = oldHashes[i];
+		}
+	}
+}
+
+Intern::ID Intern::add(LPCSTR str, size_t len)
+{
+	if (len == 0)
+		return(EMPTY);
+
+	// Id zero is the empty string
+	if (strings.empty())
+	{
+		strings.push_back(emptyString);
+		lengths.push_back(0);
+	}
+
+	if (((strings.size() + 1) * 4) > (slots.size() * 3))
+		grow();
+
+	UINT hash = hashString(str, len);
+	UINT slot = findSlot(str, len, hash);
+	if (slots[slot] == EMPTY_SLOT)
+	{
+		slots[slot] = (ID) strings.size();
+		slotHashes[slot] = hash;
+		strings.push_back(storage.addString(str, len));
+		lengths.push_back((UINT) len);
+	}
+	return(slots[slot]);
+}
+
+LPCSTR Intern::get(ID id)
+{
+	return((id < strings.size()) ? strings[id] : emptyString);
+}
+
+UINT Intern::size() { return(strings.empty() ? 0 : ((UINT) strings.size() - 1)); }
+
+void Intern::clear()
+{
+	strings.clear();
+	lengths.clear();
+	slots.clear();
+	slotHashes.clear();
+	storage.clear();
+}
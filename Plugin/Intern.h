@@ -0,0 +1,23 @@
+
+// ****************************************************************************
+// File: Intern.h
+// Desc: Interned string table
+//
+// ****************************************************************************
+#pragma once
+
+// Each distinct string is stored once in an arena and referred to by a 32bit id.
+// Equal strings get equal ids, so they compare as integers.
+namespace Intern
+{
+	typedef UINT ID;
+	// The empty string
+	const ID EMPTY = 0;
+
+	ID add(LPCSTR str, size_t len);
+	inline ID add(LPCSTR str) { return(add(str, strlen(str))); }
+	LPCSTR get(ID id);
+
+	UINT size();
+	void clear();
+}
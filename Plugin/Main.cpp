@@ -8,8 +8,19 @@
 #include "Main.h"
 #include "Vftable.h"
 #include "RTTI.h"
+#include "SegCache.h"
+#include "Simd.h"
+#include "Parallel.h"
+#include "RefTable.h"
+#include "RefIndex.h"
+#include "AddrIndex.h"
+#include "PeInfo.h"
+#include "EditQueue.h"
+#include "Demangle.h"
+#include "NameCache.h"
 #include "MainDialog.h"
 #include <map>
+#include <algorithm>
 //
 #include <WaitBoxEx.h>
 #include <IdaOgg.h>
@@ -20,12 +31,14 @@ typedef std::map<ea_t, std::string> STRMAP;
 const static char NETNODE_NAME[] = {"$ClassInformer_node"};
 const char NN_DATA_TAG  = 'A';
 const char NN_TABLE_TAG = 'S';
+const char NN_SEGS_TAG  = 'H';
 
 // Our netnode value indexes
 enum NETINDX
 {
     NIDX_VERSION,   // ClassInformer version
-    NIDX_COUNT      // Table entry count
+    NIDX_COUNT,     // Table entry count
+    NIDX_SEGCOUNT   // Scanned segment record count
 };
 
 // VFTable entry container (fits in a netnode MAXSPECSIZE size)
@@ -38,6 +51,13 @@ struct TBLENTRY
     WORD strSize;
     char str[MAXSPECSIZE - (sizeof(ea_t) + (sizeof(WORD) * 3))]; // Note: IDA MAXSTR = 1024
 };
+
+// Scanned segment record, to only rescan the segments that changed
+struct SEGHASH
+{
+    ea_t start, end;
+    UINT64 hash;
+};
 #pragma pack(pop)
 
 // Line background color for non parent/top level hierarchy lines
@@ -56,10 +76,17 @@ static HMODULE myModuleHandle = NULL;
 static UINT staticCCtorCnt = 0, staticCppCtorCnt = 0, staticCDtorCnt = 0;
 static UINT startingFuncCount = 0, staticCtorDtorCnt = 0;
 static UINT colCount = 0, missingColsFixed = 0, vftablesFixed = 0;
+static UINT uniqueMethods = 0;
 static BOOL initResourcesOnce = FALSE;
 static int  chooserIcon = 0;
 static netnode *netNode = NULL;
 static eaList colList;
+static BOOL rescanChanged = FALSE;
+static UINT reusedVftables = 0, reusedSegs = 0;
+// Parsed CHD cache use and the time spent filling it
+static UINT chdParsed = 0;
+static UINT64 chdReused = 0;
+static double chdTime = 0.0;
 
 // Options
 BOOL optionPlaceStructs	 = TRUE;
@@ -72,6 +99,8 @@ static void freeWorkingData()
     try
     {
         RTTI::freeWorkingData();
+        SegCache::clear();
+        NameCache::clear();
         colList.clear();
 
         if (netNode)
@@ -129,10 +158,12 @@ static void newNetnodeStore()
     // Kill any existing store data first
     netNode->altdel_all(NN_DATA_TAG);
     netNode->supdel_all(NN_TABLE_TAG);
+    netNode->supdel_all(NN_SEGS_TAG);
 
     // Init defaults
-    netNode->altset_idx8(NIDX_VERSION, MY_VERSION, NN_DATA_TAG);
-    netNode->altset_idx8(NIDX_COUNT,   0,          NN_DATA_TAG);
+    netNode->altset_idx8(NIDX_VERSION,  MY_VERSION, NN_DATA_TAG);
+    netNode->altset_idx8(NIDX_COUNT,    0,          NN_DATA_TAG);
+    netNode->altset_idx8(NIDX_SEGCOUNT, 0,          NN_DATA_TAG);
 }
 
 static WORD getStoreVersion(){ return((WORD)netNode->altval_idx8(NIDX_VERSION, NN_DATA_TAG)); }
@@ -140,6 +171,17 @@ static UINT getTableCount(){ return(netNode->altval_idx8(NIDX_COUNT, NN_DATA_TAG
 static BOOL setTableCount(UINT count){ return(netNode->altset_idx8(NIDX_COUNT, count, NN_DATA_TAG)); }
 static BOOL getTableEntry(TBLENTRY &entry, UINT index){ return(netNode->supval(index, &entry, sizeof(TBLENTRY), NN_TABLE_TAG) > 0); }
 static BOOL setTableEntry(TBLENTRY &entry, UINT index){ return(netNode->supset(index, &entry, (offsetof(TBLENTRY, str) + entry.strSize), NN_TABLE_TAG)); }
+static UINT getSegHashCount(){ return(netNode->altval_idx8(NIDX_SEGCOUNT, NN_DATA_TAG)); }
+static BOOL setSegHashCount(UINT count){ return(netNode->altset_idx8(NIDX_SEGCOUNT, count, NN_DATA_TAG)); }
+static BOOL getSegHash(SEGHASH &sh, UINT index){ return(netNode->supval(index, &sh, sizeof(SEGHASH), NN_SEGS_TAG) == sizeof(SEGHASH)); }
+
+// Append an entry to the stored vftable list
+static void putTableEntry(TBLENTRY &e)
+{
+	UINT count = getTableCount();
+	setTableEntry(e, count);
+	setTableCount(++count);
+}
 
 // Add an entry to the vftable list
 void addTableEntry(UINT flags, ea_t vft, int methodCount, LPCTSTR format, ...)
@@ -155,9 +197,12 @@ void addTableEntry(UINT flags, ea_t vft, int methodCount, LPCTSTR format, ...)
 	va_end(vl);
 	e.strSize = (WORD) (strlen(e.str) + 1);
 
-	UINT count = getTableCount();
-	setTableEntry(e, count);
-	setTableCount(++count);
+	if (EditQueue::isActive())
+	{
+		EditQueue::add(vft, [=]() mutable { putTableEntry(e); });
+		return;
+	}
+	putTableEntry(e);
 }
 
 
@@ -391,7 +436,10 @@ bool idaapi run(size_t arg)
         startingFuncCount   = (UINT) get_func_qty();
 		colList.clear();
         staticCppCtorCnt = staticCCtorCnt = staticCtorDtorCnt = staticCDtorCnt = 0;
-		missingColsFixed = vftablesFixed = 0;
+		missingColsFixed = vftablesFixed = uniqueMethods = 0;
+		chdParsed = 0;
+		chdReused = 0;
+		chdTime = 0.0;
 
         // Create storage netnode
         if(!(netNode = new netnode(NETNODE_NAME, SIZESTR(NETNODE_NAME), TRUE)))
@@ -404,6 +452,8 @@ bool idaapi run(size_t arg)
         UINT tableCount     = getTableCount();
         WORD storageVersion = getStoreVersion();
         BOOL storageExists  = (tableCount > 0);
+        rescanChanged = FALSE;
+        reusedVftables = reusedSegs = 0;
 
         // Ask if we should use storage or process again
 		if (storageExists)
@@ -414,6 +464,14 @@ bool idaapi run(size_t arg)
 			{
 				msg("* Storage version mismatch, must rescan *\n");
 			}
+			else
+			if (getSegHashCount() > 0)
+			{
+				// Can also keep the stored result of the segments that didn't change
+				int iResult = ask_buttons("~U~se stored", "Rescan ~c~hanged", "Rescan ~a~ll", 1, "TITLE Class Informer \nUse previously stored result?        ");
+				storageExists = (iResult == 1);
+				rescanChanged = (iResult == 0);
+			}
 			else
 				storageExists = (ask_yn(1, "TITLE Class Informer \nHIDECANCEL\nUse previously stored result?        ") == 1);
 		}
@@ -421,7 +479,9 @@ bool idaapi run(size_t arg)
         BOOL aborted = FALSE;
         if(!storageExists)
         {
-            newNetnodeStore();
+            // When only rescanning the changed segments the store is reset once they are known
+            if (!rescanChanged)
+                newNetnodeStore();
 
             // Only MS Visual C++ targets are supported
             comp_t cmp = get_comp(default_compiler());
@@ -489,6 +549,7 @@ bool idaapi run(size_t arg)
                     }
 
                     showEndStats();
+                    NameCache::clear();
                     msg("Done.\n\n");
                 }
             }
@@ -530,15 +591,34 @@ static void showEndStats()
 		msg("  RTTI vftables: %u, fixed: %u (%.1f%%)\n", vftableCount, vftablesFixed, ((double) vftablesFixed / (double) vftableCount)  * 100.0);
 		else
 		msg("  RTTI vftables: %u\n", vftableCount);
+		if (reusedSegs)
+		msg("  Kept from last run: %u vftables, %u unchanged segments\n", reusedVftables, reusedSegs);
 
 		// Amount of COLs fixed is usually about the same as vftables fixed, but the same COL can be used in multiple vftables
 		//if(missingColsFixed)
 		//msg("     COLs fixed: %u of %u (%.1f%%)\n", missingColsFixed, colCount,  ((double) missingColsFixed / (double) colCount)  * 100.0);
 
+		if (uniqueMethods)
+		msg(" Vftable methods: %u unique\n", uniqueMethods);
+
 		UINT functionsFixed = ((UINT) get_func_qty() - startingFuncCount);
 		if(functionsFixed)
         msg("Functions fixed: %u\n", functionsFixed);
 
+        UINT64 hits, misses;
+        NameCache::getStats(hits, misses);
+        if (hits || misses)
+        {
+            char numBuffer1[32], numBuffer2[32], numBuffer3[32];
+            msg(" Demangle cache: %s names, %s hits, %s misses\n", prettyNumberString(NameCache::size(), numBuffer1), prettyNumberString(hits, numBuffer2), prettyNumberString(misses, numBuffer3));
+        }
+
+        if (chdParsed)
+        {
+            char numBuffer1[32], numBuffer2[32];
+            msg("      CHD cache: %s parsed, %s reused, time: %.3f\n", prettyNumberString(chdParsed, numBuffer1), prettyNumberString(chdReused, numBuffer2), chdTime);
+        }
+
         msg("Processing time: %s\n", timeString(getTimeStamp() - s_startTime));
     }
     CATCH()
@@ -1065,9 +1145,13 @@ inline void killAnteriorComments(ea_t ea)
     delete_extra_cmts(ea, E_PREV);
 }
 
+// The IDB write helpers below queue themselves while the edit queue is active
+#define QUEUE_EDIT(_ea, _edit) { if (EditQueue::isActive()) { EditQueue::add((_ea), (_edit)); return; } }
+
 // Force a memory location to be DWORD size
 void fixDword(ea_t ea)
 {
+    QUEUE_EDIT(ea, [=]() { fixDword(ea); });
     if (!is_dword(get_flags(ea)))
     {
         setUnknown(ea, sizeof(DWORD));
@@ -1078,6 +1162,7 @@ void fixDword(ea_t ea)
 // Force memory location to be ea_t size
 void fixEa(ea_t ea)
 {
+    QUEUE_EDIT(ea, [=]() { fixEa(ea); });
     #ifndef __EA64__
     if (!is_dword(get_flags(ea)))
     #else
@@ -1093,22 +1178,87 @@ void fixEa(ea_t ea)
     }
 }
 
+// Record the bounds of a function made while auto-analysis is suspended
+static void touchFunction(ea_t ea)
+{
+    if (EditQueue::isSuspended())
+    {
+        if (func_t *func = get_func(ea))
+            EditQueue::touch(func->start_ea, func->end_ea);
+    }
+}
+
 // Address should be a code function
 void fixFunction(ea_t ea)
 {
+    QUEUE_EDIT(ea, [=]() { fixFunction(ea); });
     flags_t flags = get_flags(ea);
 
 	// No code here?
     if (!is_code(flags))
     {
-		// Attempt to make it so
+		// Attempt to make it so, with the exact bounds when .pdata has them
         create_insn(ea);
-        add_func(ea, BADADDR);
+        add_func(ea, PeInfo::getFunctionEnd(ea));
     }
     else
 	// Yea there is code here, should have a function boddy too
     if (!is_func(flags))
-        add_func(ea, BADADDR);
+        add_func(ea, PeInfo::getFunctionEnd(ea));
+    touchFunction(ea);
+}
+
+// Vftable method targets, their functions get created in one batch after the analysis
+static qvector<ea_t> methodList;
+
+// Add a vftable method for createMethodFunctions()
+void addMethod(ea_t ea)
+{
+    methodList.push_back(ea);
+}
+
+// Create the missing functions of the unique vftable methods in address order.
+// The ones with .pdata bounds are made directly, the rest go to the auto analysis queues.
+// Marking works with auto-analysis off, the queues are processed whenever it's on.
+// Returns TRUE if aborted
+static BOOL createMethodFunctions()
+{
+    // The same methods (_purecall, default destructors, folded stubs, etc.) show up in lots of vftables
+    std::sort(methodList.begin(), methodList.end());
+    methodList.resize(std::unique(methodList.begin(), methodList.end()) - methodList.begin());
+    uniqueMethods += (UINT) methodList.size();
+
+    BOOL aborted = FALSE;
+    for (qvector<ea_t>::const_iterator it = methodList.begin(), end = methodList.end(); it != end; ++it)
+    {
+        ea_t ea = *it;
+        flags_t flags = get_flags(ea);
+        if (is_func(flags))
+            continue;
+
+        ea_t funcEnd = PeInfo::getFunctionEnd(ea);
+        if (funcEnd != BADADDR)
+        {
+            if (!is_code(flags))
+                create_insn(ea);
+            add_func(ea, funcEnd);
+            touchFunction(ea);
+        }
+        else
+        {
+            if (!is_code(flags))
+                auto_mark_range(ea, (ea + 1), AU_CODE);
+            auto_mark_range(ea, (ea + 1), AU_PROC);
+        }
+
+        if (WaitBox::isUpdateTime())
+        {
+            if (aborted = WaitBox::updateAndCancelCheck())
+                break;
+        }
+    }
+    methodList.clear();
+    return(aborted);
 }
 
 // Get IDA EA bit value with verification
@@ -1136,9 +1286,22 @@ BOOL getPlainTypeName(__in LPCSTR mangled, __out_bcount(MAXSTR) LPSTR outStr)
 {
     outStr[0] = outStr[MAXSTR - 1] = 0;
 
-    // Use CRT function for type names
+    // Each type only gets demangled once per run
+    if (LPCSTR plain = NameCache::find(mangled))
+    {
+        strncpy_s(outStr, MAXSTR, plain, (MAXSTR - 1));
+        return(TRUE);
+    }
+
+    // Native demangler for type names, the CRT one for the encodings it doesn't cover
     if (mangled[0] == '.')
     {
+        if (Demangle::typeName((mangled + 1), outStr, MAXSTR))
+        {
+            NameCache::add(mangled, outStr);
+            return(TRUE);
+        }
+
         __unDName(outStr, mangled + 1, MAXSTR, mallocWrap, free, (UNDNAME_32_BIT_DECODE | UNDNAME_TYPE_ONLY | UNDNAME_NO_ECSU));
         if ((outStr[0] == 0) || (strcmp((mangled + 1), outStr) == 0))
         {
@@ -1163,6 +1326,7 @@ BOOL getPlainTypeName(__in LPCSTR mangled, __out_bcount(MAXSTR) LPSTR outStr)
             *ending = 0;
     }
 
+    NameCache::add(mangled, outStr);
     return(TRUE);
 }
 
@@ -1212,7 +1376,9 @@ int addStrucMember(struc_t *sptr, char *name, ea_t offset, flags_t flag, opinfo_
 
 void setUnknown(ea_t ea, int size)
 {
+	QUEUE_EDIT(ea, [=]() { setUnknown(ea, size); });
 	del_items(ea, DELIT_EXPAND, size);
+	EditQueue::touch(ea, (ea + size));
 
 #if 0
     // TODO: Does the item overrun problem still exist in IDA 7?
@@ -1234,6 +1400,12 @@ void setUnknown(ea_t ea, int size)
 // Set name for address
 void setName(ea_t ea, __in LPCSTR name)
 {
+	if (EditQueue::isActive())
+	{
+		qstring s(name);
+		EditQueue::add(ea, [=]() { setName(ea, s.c_str()); });
+		return;
+	}
 	//msg("%08X \"%s\"\n", ea, name);
 	set_name(ea, name, (SN_NON_AUTO | SN_NOWARN | SN_NOCHECK | SN_FORCE));
 }
@@ -1241,6 +1413,12 @@ void setName(ea_t ea, __in LPCSTR name)
 // Set comment at address
 void setComment(ea_t ea, LPCSTR comment, BOOL rptble)
 {
+	if (EditQueue::isActive())
+	{
+		qstring s(comment);
+		EditQueue::add(ea, [=]() { setComment(ea, s.c_str(), rptble); });
+		return;
+	}
 	//msg("%08X cmt: \"%s\"\n", ea, comment);
 	set_cmt(ea, comment, rptble);
 }
@@ -1250,179 +1428,702 @@ void setAnteriorComment(ea_t ea, const char *format, ...)
 {
 	va_list va;
 	va_start(va, format);
-	vadd_extra_line(ea, 0, format, va);
+	if (EditQueue::isActive())
+	{
+		qstring s;
+		s.cat_vsprnt(format, va);
+		EditQueue::add(ea, [=]() { setAnteriorComment(ea, "%s", s.c_str()); });
+	}
+	else
+		vadd_extra_line(ea, 0, format, va);
 	va_end(va);
 }
 
 
-// Scan segment for COLs
-static BOOL scanSeg4Cols(segment_t *seg)
+// Scan work unit size
+static const ea_t SCAN_BLOCK_SIZE = (256 * 1024);
+
+// Address range [start, end)
+struct EARANGE
+{
+    ea_t start, end;
+};
+
+// Segments that can hold type descriptors
+static BOOL isTypeInfoSegment(segment_t *seg)
+{
+	switch (seg->type)
+	{
+		// Merged code/data sections hold them too, only skip code that can't be read
+		case SEG_CODE:
+		return((seg->perm == 0) || ((seg->perm & SEGPERM_READ) != 0));
+
+		case SEG_XTRN:
+		case SEG_IMP:
+		case SEG_GRP:
+		case SEG_NULL:
+		return(FALSE);
+	};
+	return(TRUE);
+}
+
+// Every type descriptor found by name, when 'useTdIndex' is set
+static refTable tdIndex;
+static BOOL useTdIndex = FALSE;
+// The type_info vftables the type descriptors in 'tdIndex' point to
+static qvector<ea_t> learnedTiVftables;
+
+#ifdef __EA64__
+// Span of the scanned segments, where all COLs live
+static ea_t scanLo = 0, scanHi = 0;
+#else
+// Ranges of the segments that can hold type descriptors
+static qvector<Simd::range32> tdRanges;
+// Ranges of the scanned segments, where all COLs live
+static qvector<Simd::range32> scanRanges;
+
+static void getTypeInfoRanges(__out qvector<Simd::range32> &ranges)
+{
+	ranges.clear();
+	int segCount = get_segm_qty();
+	for (int i = 0; i < segCount; i++)
+	{
+		if (segment_t *seg = getnseg(i))
+		{
+			if (!isTypeInfoSegment(seg))
+				continue;
+
+			// Same lower bound the scalar check used
+			ea_t lo = ((seg->start_ea < 0x10000) ? 0x10000 : seg->start_ea);
+			if (lo >= seg->end_ea)
+				continue;
+
+			// Segments come in address order, merge adjacent ones
+			if (!ranges.empty() && (ranges.back().hi == (UINT) lo))
+				ranges.back().hi = (UINT) seg->end_ea;
+			else
+			{
+				Simd::range32 r = { (UINT) lo, (UINT) seg->end_ea };
+				ranges.push_back(r);
+			}
+		}
+	}
+}
+#endif
+
+// Ranges of the segments whose slots are scanned, only the changed ones when rescanning.
+// The rest stay snapshotted and indexed for the references into them.
+static qvector<EARANGE> candidateRanges;
+static BOOL partialScan = FALSE;
+
+// Address is in one of the segments being scanned
+static BOOL isCandidateEa(ea_t ea)
 {
-	qstring name;
-    if (get_segm_name(&name, seg) <= 0)
-		name = "???";
-    msg(" N: \"%s\", A: " EAFORMAT " - " EAFORMAT ", S: %s.\n", name.c_str(), seg->start_ea, seg->end_ea, byteSizeString(seg->size()));
+	qvector<EARANGE>::const_iterator it = std::upper_bound(candidateRanges.begin(), candidateRanges.end(), ea, [](ea_t a, const EARANGE &b) { return(a < b.start); });
+	return((it != candidateRanges.begin()) && (ea < (it - 1)->end));
+}
 
-    UINT found = 0;
-    if (seg->size() >= sizeof(RTTI::_RTTICompleteObjectLocator))
+// Free the scan lookup data
+static void freeScanData()
+{
+	AddrIndex::clear();
+	tdIndex.clear();
+	useTdIndex = FALSE;
+	learnedTiVftables.clear();
+	RefIndex::clear();
+	vftable::clearColSlots();
+	PeInfo::clear();
+	methodList.clear();
+	EditQueue::clear();
+	candidateRanges.clear();
+	partialScan = FALSE;
+	#ifndef __EA64__
+	tdRanges.clear();
+	scanRanges.clear();
+	#endif
+}
+
+
+// Type descriptor name search work unit, one block of a segment
+struct TDHIT
+{
+    ea_t td;
+    BOOL deferred;  // Needs IDB access, validate it on the main thread
+};
+
+struct TDCHUNK
+{
+    const SegCache::snapshot *snap;
+    ea_t start, end;
+    qvector<TDHIT> hits;
+};
+
+// Find the type descriptors in a block by their name prefix
+// Runs on the worker threads, reads only from the segment snapshots
+static void analyzeTdChunk(TDCHUNK &chunk)
+{
+    SegCache::workerScope scope;
+
+    // A name can run past the block end, it only has to start in it
+    qvector<UINT> offsets;
+    Simd::findTypeNames(chunk.snap->ptr(chunk.start), (size_t) (chunk.end - chunk.start), offsets);
+
+    for (qvector<UINT>::const_iterator it = offsets.begin(), end = offsets.end(); it != end; ++it)
     {
-        ea_t startEA = ((seg->start_ea + sizeof(UINT)) & ~((ea_t) (sizeof(UINT) - 1)));
-        ea_t endEA   = (seg->end_ea - sizeof(RTTI::_RTTICompleteObjectLocator));
+        ea_t name = (chunk.start + (ea_t) *it);
+        if ((name - chunk.snap->start) < offsetof(RTTI::type_info, _M_d_name))
+            continue;
+
+        ea_t td = (name - offsetof(RTTI::type_info, _M_d_name));
+        SegCache::clearMiss();
+        BOOL valid = RTTI::type_info::isValid(td);
+        if (valid || SegCache::hadMiss())
+        {
+            TDHIT hit = { td, !valid };
+            chunk.hits.push_back(hit);
+        }
+    }
+}
 
-        for (ea_t ptr = startEA; ptr < endEA;)
+// Add a block's type descriptors to the index, in address order
+static BOOL commitTdChunk(TDCHUNK &chunk)
+{
+    for (qvector<TDHIT>::const_iterator it = chunk.hits.begin(), end = chunk.hits.end(); it != end; ++it)
+    {
+        if (!it->deferred || RTTI::type_info::isValid(it->td))
+            tdIndex.add(it->td);
+    }
+    chunk.hits.clear();
+
+    if (WaitBox::isUpdateTime())
+        if (WaitBox::updateAndCancelCheck())
+            return(TRUE);
+    return(FALSE);
+}
+
+// Build 'tdIndex' by searching every segment that can hold type descriptors for their ".?AV"/".?AU" names.
+// The COL scan then looks its type descriptor pointers up instead of validating each one.
+// Returns TRUE if aborted
+static BOOL buildTypeInfoIndex()
+{
+    TIMESTAMP startTime = getTimeStamp();
+    tdIndex.clear();
+    useTdIndex = FALSE;
+
+    qvector<TDCHUNK> chunks;
+    int segCount = get_segm_qty();
+    for (int i = 0; i < segCount; i++)
+    {
+        segment_t *seg = getnseg(i);
+        if (!seg || !isTypeInfoSegment(seg) || (seg->type == SEG_BSS))
+            continue;
+
+        TDCHUNK chunk;
+        chunk.snap = SegCache::add(seg);
+        if (!chunk.snap)
+            continue;
+        for (ea_t block = seg->start_ea; block < seg->end_ea; block += SCAN_BLOCK_SIZE)
         {
-            #ifdef __EA64__
-            // Check for possible COL here
-            // Signature will be one
-            // TODO: Is this always 1 or can it be zero like 32bit?
-            if (get_32bit(ptr + offsetof(RTTI::_RTTICompleteObjectLocator, signature)) == 1)
-            {
-                if (RTTI::_RTTICompleteObjectLocator::isValid(ptr))
-                {
-                    // yes
-                    colList.push_front(ptr);
-					missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(ptr);
-                    ptr += sizeof(RTTI::_RTTICompleteObjectLocator);
-                    continue;
-                }
-            }
-            else
-            {
-                // TODO: Should we check stray BCDs?
-                // Each value would have to be tested for a valid type_def and
-                // the pattern is pretty ambiguous.
-            }
-            #else
-            // TypeDescriptor address here?
-            ea_t ea = getEa(ptr);
-            if (ea >= 0x10000)
+            chunk.start = block;
+            chunk.end   = (((seg->end_ea - block) > SCAN_BLOCK_SIZE) ? (block + SCAN_BLOCK_SIZE) : seg->end_ea);
+            chunks.push_back(chunk);
+        }
+    }
+
+    BOOL aborted = Parallel::run(chunks.size(),
+        [&](size_t i) { analyzeTdChunk(chunks[i]); },
+        [&](size_t i) { return(commitTdChunk(chunks[i])); });
+    if (aborted)
+        return(TRUE);
+
+    tdIndex.seal();
+    useTdIndex = !tdIndex.empty();
+
+    char numBuffer[32];
+    msg("Type descriptors by name: %s, time: %.3f\n", prettyNumberString(tdIndex.size(), numBuffer), (getTimeStamp() - startTime));
+    return(FALSE);
+}
+
+
+// Scan work unit, one block of a segment
+struct COLHIT
+{
+    ea_t ptr;       // Scan slot; the COL for 64bit, it's type descriptor pointer for 32bit
+    BOOL deferred;  // Needs IDB access, validate it on the main thread
+};
+
+struct VFTHIT
+{
+    ea_t ptr;       // Scan slot holding the COL pointer, the vftable follows it
+    ea_t col;
+};
+
+struct SCANCHUNK
+{
+    segment_t *seg;
+    const SegCache::snapshot *snap;
+    ea_t start, end;
+    ea_t colEnd;        // COL slots stop short of the block end at the segment tail
+    BOOL first, last;   // First/last block of the segment
+    #ifndef __EA64__
+    BOOL useFixups;         // Segment has relocations, candidates come from them instead of every slot
+    qvector<UINT> fixups;   // Dword indexes of the aligned relocated slots in the block
+    #endif
+    qvector<COLHIT> cols;
+    qvector<VFTHIT> vfts;
+};
+
+// Commit stage state, carried across the work units in address order
+struct SCANSTATE
+{
+    ea_t nextEA;
+    UINT colFound, vftFound;
+    UINT vftKnown;              // Total of the vftables whose COL was already placed when seen
+    refTable cols;              // COLs placed so far, with their vftable ref counts
+    qvector<VFTHIT> pending;    // Vftables, processed once all the COLs are known
+};
+
+// Build the scan work units for the sorted ranges [first, last) of a segment
+static void addScanChunks(segment_t *seg, const EARANGE *first, const EARANGE *last, __out qvector<SCANCHUNK> &chunks)
+{
+    SCANCHUNK chunk;
+    chunk.seg  = seg;
+    chunk.snap = SegCache::add(seg);
+    chunk.start = chunk.end = chunk.colEnd = seg->start_ea;
+    chunk.first = TRUE;
+    chunk.last  = FALSE;
+    #ifndef __EA64__
+    // Every absolute pointer in a relocatable image has a fixup, so if the segment has any,
+    // the type descriptor and COL pointers we're after are all among them.
+    chunk.useFixups = (get_next_fixup_ea(seg->start_ea - 1) < seg->end_ea);
+    #endif
+
+    if (chunk.snap && (seg->size() >= (sizeof(ea_t) * 2)))
+    {
+        // Align 4 for either 32bit or 64bit targets
+        ea_t segStart = ((seg->start_ea + sizeof(UINT)) & ~((ea_t) (sizeof(UINT) - 1)));
+        ea_t segEnd   = (seg->end_ea - sizeof(ea_t));
+        chunk.colEnd = ((seg->size() >= sizeof(RTTI::_RTTICompleteObjectLocator)) ? (seg->end_ea - sizeof(RTTI::_RTTICompleteObjectLocator)) : seg->start_ea);
+
+        for (const EARANGE *r = first; r != last; r++)
+        {
+            ea_t startEA = ((r->start + (sizeof(UINT) - 1)) & ~((ea_t) (sizeof(UINT) - 1)));
+            if (startEA < segStart)
+                startEA = segStart;
+            ea_t endEA = ((r->end < segEnd) ? r->end : segEnd);
+
+            for (ea_t block = startEA; block < endEA; block += SCAN_BLOCK_SIZE)
             {
-                if (RTTI::type_info::isValid(ea))
+                chunk.start = block;
+                chunk.end   = (((endEA - block) > SCAN_BLOCK_SIZE) ? (block + SCAN_BLOCK_SIZE) : endEA);
+                #ifndef __EA64__
+                // The workers can't read the fixups, gather them here
+                chunk.fixups.clear();
+                if (chunk.useFixups)
                 {
-                    // yes, a COL here?
-                    ea_t col = (ptr - offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
-                    if (RTTI::_RTTICompleteObjectLocator::isValid2(col))
+                    for (ea_t ea = get_next_fixup_ea(block - 1); (ea != BADADDR) && (ea < chunk.end); ea = get_next_fixup_ea(ea))
                     {
-                        // yes
-                        colList.push_front(col);
-						missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(col);
-                        ptr += sizeof(RTTI::_RTTICompleteObjectLocator);
-                        continue;
+                        if ((ea & (sizeof(UINT) - 1)) == 0)
+                            chunk.fixups.push_back((UINT) ((ea - block) / sizeof(UINT)));
                     }
-                    /*
-                    else
-                    // No, is it a BCD then?
-                    if (RTTI::_RTTIBaseClassDescriptor::isValid2(ptr))
-                    {
-                        // yes
-                        char dontCare[MAXSTR];
-                        RTTI::_RTTIBaseClassDescriptor::doStruct(ptr, dontCare);
-                    }
-                    */
                 }
+                #endif
+                chunks.push_back(chunk);
+                chunk.first = FALSE;
             }
-            #endif
+        }
+    }
 
-            if (WaitBox::isUpdateTime())
-                if (WaitBox::updateAndCancelCheck())
-                    return(TRUE);
+    // Always at least one so the segment still gets reported
+    if (chunk.first)
+        chunks.push_back(chunk);
+    chunks.back().last = TRUE;
+}
+
+#ifndef __EA64__
+// Relocated slots in the first 'count' dwords of the block that point inside one of the sorted 'ranges'
+static void filterFixups(const SCANCHUNK &chunk, size_t count, const qvector<Simd::range32> &ranges, __out qvector<UINT> &candidates)
+{
+    const UINT *data = (const UINT *) chunk.snap->ptr(chunk.start);
+    for (qvector<UINT>::const_iterator it = chunk.fixups.begin(), end = chunk.fixups.end(); (it != end) && (*it < count); ++it)
+    {
+        UINT value = data[*it];
+        const Simd::range32 *r = std::upper_bound(ranges.begin(), ranges.end(), value, [](UINT a, const Simd::range32 &b) { return(a < b.lo); });
+        if ((r != ranges.begin()) && (value < (r - 1)->hi))
+            candidates.push_back(*it);
+    }
+}
+#endif
+
+// Find COL candidates in a block
+static void findColHits(SCANCHUNK &chunk)
+{
+    if (chunk.start >= chunk.colEnd)
+        return;
+
+    ea_t end = ((chunk.end < chunk.colEnd) ? chunk.end : chunk.colEnd);
+    size_t count = (size_t) (((end - chunk.start) + (sizeof(UINT) - 1)) / sizeof(UINT));
+
+    // Vector prefilter, only the surviving candidates go to the validators
+    qvector<UINT> candidates;
+    #ifdef __EA64__
+    // Signature is one and 'objectBase' is the COL's own RVA from a 64K aligned image base,
+    // not necessarily the IDB's image base as it can hold more than one module
+    // TODO: Is the signature always 1 or can it be zero like 32bit?
+    Simd::findColCandidates64(chunk.snap->ptr(chunk.start), count, (UINT) chunk.start, candidates);
+    #else
+    // Values that point into where type descriptors can live
+    if (chunk.useFixups)
+        filterFixups(chunk, count, tdRanges, candidates);
+    else
+        Simd::findPtrCandidates32(chunk.snap->ptr(chunk.start), count, tdRanges.begin(), tdRanges.size(), candidates);
+    #endif
+
+    for (qvector<UINT>::const_iterator it = candidates.begin(), end = candidates.end(); it != end; ++it)
+    {
+        ea_t ptr = (chunk.start + ((ea_t) *it * sizeof(UINT)));
+        SegCache::clearMiss();
 
-            ptr += sizeof(UINT);
+        #ifdef __EA64__
+        if (useTdIndex)
+        {
+            // The type descriptor RVA is from the COL's own base, per its 'objectBase'
+            ea_t colBase = (ptr - (ea_t) chunk.snap->get32(ptr + offsetof(RTTI::_RTTICompleteObjectLocator, objectBase)));
+            ea_t td = (colBase + (ea_t) chunk.snap->get32(ptr + offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor)));
+            if (tdIndex.find(td) < 0)
+                continue;
+        }
+        BOOL valid = RTTI::_RTTICompleteObjectLocator::isValid(ptr);
+        // TODO: Should we check stray BCDs?
+        // Each value would have to be tested for a valid type_def and
+        // the pattern is pretty ambiguous.
+        #else
+        // TypeDescriptor address here, and a COL around it?
+        ea_t td = chunk.snap->getEa(ptr);
+        BOOL valid = FALSE;
+        if (useTdIndex ? (tdIndex.find(td) >= 0) : RTTI::type_info::isValid(td))
+            valid = RTTI::_RTTICompleteObjectLocator::isValid2(ptr - offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
+        #endif
+
+        if (SegCache::hadMiss())
+        {
+            COLHIT hit = { ptr, TRUE };
+            chunk.cols.push_back(hit);
+        }
+        else
+        if (valid)
+        {
+            COLHIT hit = { ptr, FALSE };
+            chunk.cols.push_back(hit);
         }
     }
+}
 
-    if (found)
+// Find vftable candidates in a block: an aligned pointer into the scanned segments followed by a pointer to code.
+// Only cheap tests here, the commit stage keeps the ones that point to a COL it placed.
+static void findVftableHits(SCANCHUNK &chunk)
+{
+    size_t count = (size_t) (((chunk.end - chunk.start) + (sizeof(UINT) - 1)) / sizeof(UINT));
+
+    // Walk uint32 at the time, at align 4 (same for either 32bit or 64bit targets)
+    qvector<UINT> candidates;
+    #ifdef __EA64__
+    const BYTE *data = chunk.snap->ptr(chunk.start);
+    ea_t scanSpan = (scanHi - scanLo);
+    for (size_t i = 0; i < count; i++)
     {
-        char numBuffer[32];
-        msg(" Count: %s\n", prettyNumberString(found, numBuffer));
+        ea_t value = *((const ea_t *) (data + (i * sizeof(UINT))));
+        if (((value - scanLo) < scanSpan) && !(value & (sizeof(UINT) - 1)))
+            candidates.push_back((UINT) i);
+    }
+    #else
+    if (chunk.useFixups)
+        filterFixups(chunk, count, scanRanges, candidates);
+    else
+        Simd::findPtrCandidates32(chunk.snap->ptr(chunk.start), count, scanRanges.begin(), scanRanges.size(), candidates);
+    #endif
+
+    for (qvector<UINT>::const_iterator it = candidates.begin(), end = candidates.end(); it != end; ++it)
+    {
+        ea_t ptr = (chunk.start + ((ea_t) *it * sizeof(UINT)));
+        ea_t col = chunk.snap->getEa(ptr);
+        if (col & (sizeof(UINT) - 1))
+            continue;
+        if (!AddrIndex::isCode(chunk.snap->getEa(ptr + sizeof(ea_t))))
+            continue;
+
+        VFTHIT hit = { ptr, col };
+        chunk.vfts.push_back(hit);
     }
+}
+
+// Find COL and vftable candidates in a block
+// Runs on the worker threads, reads only from the segment snapshots
+static void analyzeScanChunk(SCANCHUNK &chunk)
+{
+    if (chunk.start >= chunk.end)
+        return;
+
+    SegCache::workerScope scope;
+    findColHits(chunk);
+    findVftableHits(chunk);
+}
+
+// Place the COLs and vftables found in a block
+// Runs on the main thread in address order. Returns TRUE if aborted
+static BOOL commitScanChunk(SCANCHUNK &chunk, SCANSTATE &state)
+{
+    if (chunk.first)
+    {
+        qstring name;
+        if (get_segm_name(&name, chunk.seg) <= 0)
+            name = "???";
+        msg(" N: \"%s\", A: " EAFORMAT " - " EAFORMAT ", S: %s.\n", name.c_str(), chunk.seg->start_ea, chunk.seg->end_ea, byteSizeString(chunk.seg->size()));
+        if (!chunk.snap)
+            msg(" ** Failed to read segment! **\n");
+        state.nextEA = 0;
+        state.colFound = state.vftFound = 0;
+    }
+
+    for (qvector<COLHIT>::const_iterator it = chunk.cols.begin(), end = chunk.cols.end(); it != end; ++it)
+    {
+        // Skip over the last COL placed
+        if (it->ptr < state.nextEA)
+            continue;
+
+        #ifdef __EA64__
+        ea_t col = it->ptr;
+        if (it->deferred && !RTTI::_RTTICompleteObjectLocator::isValid(col))
+            continue;
+        #else
+        ea_t col = (it->ptr - offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
+        if (it->deferred && !(RTTI::type_info::isValid(getEa(it->ptr)) && RTTI::_RTTICompleteObjectLocator::isValid2(col)))
+            continue;
+        #endif
+
+        // Already placed from its name
+        if (state.cols.find(col) >= 0)
+        {
+            state.nextEA = (it->ptr + sizeof(RTTI::_RTTICompleteObjectLocator));
+            continue;
+        }
+
+        state.cols.add(col);
+        missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(col);
+        state.nextEA = (it->ptr + sizeof(RTTI::_RTTICompleteObjectLocator));
+        state.colFound++;
+    }
+    chunk.cols.clear();
+
+    // Vftables wait for the end of the scan when all the COL pointers, their boundaries, are known
+    for (qvector<VFTHIT>::const_iterator it = chunk.vfts.begin(), end = chunk.vfts.end(); it != end; ++it)
+    {
+        state.pending.push_back(*it);
+        if (state.cols.find(it->col) >= 0)
+        {
+            state.vftFound++;
+            state.vftKnown++;
+        }
+    }
+    chunk.vfts.clear();
+
+    if (chunk.last && (state.colFound || state.vftFound))
+    {
+        char numBuffer1[32], numBuffer2[32];
+        msg(" Count: %s COL, %s vftable\n", prettyNumberString(state.colFound, numBuffer1), prettyNumberString(state.vftFound, numBuffer2));
+    }
+
+    if (WaitBox::isUpdateTime())
+        if (WaitBox::updateAndCancelCheck())
+            return(TRUE);
     return(FALSE);
 }
-//
-// Locate COL by descriptor list
-static BOOL findCols(SegSelect::segments *segList)
+
+// Give the vftable walk its boundaries: every pointer to one of the COLs
+static void setVftableBounds(const refTable &cols)
 {
-    try
+    qvector<ea_t> slots;
+    for (size_t i = 0; i < cols.size(); i++)
     {
-        TIMESTAMP startTime = getTimeStamp();
+        const RefIndex::ref *first, *last;
+        if (RefIndex::getRefsTo(cols.getEa(i), first, last))
+        {
+            for (const RefIndex::ref *r = first; r != last; r++)
+            {
+                // Not the COL's own 'objectBase' RVA
+                if (!r->isRva())
+                    slots.push_back(r->getSource());
+            }
+        }
+    }
+    vftable::setColSlots(slots);
+}
 
-		// Use user selected segments
-		if (segList && !segList->empty())
-		{
-			for (SegSelect::segments::iterator it = segList->begin(); it != segList->end(); ++it)
-			{
-				if (scanSeg4Cols(*it))
-					return(FALSE);
-			}
-		}
-		else
-		// Scan data segments named
-		{
-			int segCount = get_segm_qty();
-			for (int i = 0; i < segCount; i++)
-			{
-				if (segment_t *seg = getnseg(i))
-				{
-					if (seg->type == SEG_DATA)
-					{
-						if (scanSeg4Cols(seg))
-							return(FALSE);
-					}
-				}
-			}
-		}
+// When rescanning, add the COLs in the unchanged segments that vftables in the changed ones point to
+static void addOutsideCols(const qvector<VFTHIT> &vfts, refTable &cols)
+{
+    BOOL added = FALSE;
+    for (qvector<VFTHIT>::const_iterator it = vfts.begin(), end = vfts.end(); it != end; ++it)
+    {
+        if (isCandidateEa(it->col) || (cols.find(it->col) >= 0))
+            continue;
+        if (SegCache::find(it->col) && RTTI::_RTTICompleteObjectLocator::isValid(it->col))
+        {
+            cols.add(it->col);
+            missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(it->col);
+            added = TRUE;
+        }
+    }
+    if (added)
+        cols.seal();
+}
 
-        char numBuffer[32];
-        msg("     Total COL: %s\n", prettyNumberString(colList.size(), numBuffer));
-        msg("COL scan time: %.3f\n", (getTimeStamp() - startTime));
+// Process vftables, in address order, whose COL is in 'cols'.
+// Call once 'cols' is complete as it bounds the vftables.
+// Returns TRUE if aborted
+static BOOL processVftables(const qvector<VFTHIT> &vfts, refTable &cols, __out UINT &processed)
+{
+    if (partialScan)
+        addOutsideCols(vfts, cols);
+    setVftableBounds(cols);
+
+    processed = 0;
+    for (qvector<VFTHIT>::const_iterator it = vfts.begin(), end = vfts.end(); it != end; ++it)
+    {
+        int index = cols.find(it->col);
+        if (index >= 0)
+        {
+            vftablesFixed += (UINT) RTTI::processVftable((it->ptr + sizeof(ea_t)), it->col);
+            cols.addRef(index);
+            processed++;
+        }
+
+        if (WaitBox::isUpdateTime())
+            if (WaitBox::updateAndCancelCheck())
+                return(TRUE);
     }
-    CATCH()
     return(FALSE);
 }
 
+// Locate the vftables of the COLs that don't have one yet by the pointers to them
+// Returns TRUE if aborted
+static BOOL findVftablesByRefs(refTable &cols)
+{
+    // COL pointers followed by a pointer to code
+    qvector<VFTHIT> vfts;
+    for (size_t i = 0; i < cols.size(); i++)
+    {
+        if (cols.getRefs(i))
+            continue;
+
+        ea_t col = cols.getEa(i);
+        const RefIndex::ref *first, *last;
+        if (!RefIndex::getRefsTo(col, first, last))
+            continue;
 
-// Locate vftables
-static BOOL scanSeg4Vftables(segment_t *seg, eaRefMap &colMap)
+        for (const RefIndex::ref *r = first; r != last; r++)
+        {
+            // Skip the COL's own 'objectBase' RVA, and the vftables of the unchanged segments
+            if (r->isRva())
+                continue;
+            ea_t ref = r->getSource();
+            if (!isCandidateEa(ref))
+                continue;
+            if (AddrIndex::isCode(SegCache::getEa(ref + sizeof(ea_t))))
+            {
+                VFTHIT hit = { ref, col };
+                vfts.push_back(hit);
+            }
+        }
+    }
+
+    // Process the vftables in address order
+    std::sort(vfts.begin(), vfts.end(), [](const VFTHIT &a, const VFTHIT &b) { return(a.ptr < b.ptr); });
+    UINT processed;
+    return(processVftables(vfts, cols, processed));
+}
+
+// Every type descriptor's 'vfptr' points to type_info's own vftable
+static ea_t getTypeInfoVftable()
 {
-	qstring name;
-	if (get_segm_name(&name, seg) <= 0)
-		name = "???";
-	msg(" N: \"%s\", A: " EAFORMAT " - " EAFORMAT ", S: %s.\n", name.c_str(), seg->start_ea, seg->end_ea, byteSizeString(seg->size()));
+    return(get_name_ea(BADADDR, "??_7type_info@@6B@"));
+}
 
-    UINT foundCount = 0;
-    if (seg->size() >= sizeof(ea_t))
+// Learn the type_info vftables from their name and from every type descriptor in 'tdIndex', so
+// type_info::isValid() can reject the rest with a compare. An IDB holding several modules has one each.
+// Call after buildTypeInfoIndex().
+static void learnTypeInfoVftables()
+{
+    learnedTiVftables.clear();
+    ea_t named = getTypeInfoVftable();
+    if (named != BADADDR)
+        learnedTiVftables.push_back(named);
+
+    for (size_t i = 0; i < tdIndex.size(); i++)
+        learnedTiVftables.add_unique(SegCache::getEa(tdIndex.getEa(i) + offsetof(RTTI::type_info, vfptr)));
+    if (learnedTiVftables.empty())
+        return;
+
+    std::sort(learnedTiVftables.begin(), learnedTiVftables.end());
+    RTTI::setTypeInfoVftables(learnedTiVftables);
+    char numBuffer[32];
+    if (learnedTiVftables.size() == 1)
+        msg("type_info vftable: " EAFORMAT ", %s, from %s type descriptors\n", learnedTiVftables[0], ((named != BADADDR) ? "named" : "learned"), prettyNumberString(tdIndex.size(), numBuffer));
+    else
+        msg("type_info vftables: %u, from %s type descriptors\n", (UINT) learnedTiVftables.size(), prettyNumberString(tdIndex.size(), numBuffer));
+}
+
+// Minimum percentage of type descriptors that must lead to a COL for the reference graph to be trusted
+static const UINT REFS_MIN_COL_PERCENT = 25;
+
+// Locate COLs and their vftables by walking the references out from the type_info vftables:
+// type_info vftable -> type descriptors -> COLs -> vftables.
+// Leaves 'done' FALSE, before touching the IDB, if the reference graph is too sparse to trust.
+// Returns TRUE if aborted
+static BOOL findColsByRefs(__out refTable &cols, __out BOOL &done)
+{
+    done = FALSE;
+    if (learnedTiVftables.empty())
     {
-        ea_t startEA = ((seg->start_ea + sizeof(ea_t)) & ~((ea_t) (sizeof(ea_t) - 1)));
-        ea_t endEA   = (seg->end_ea - sizeof(ea_t));
-		_ASSERT(((startEA | endEA) & 3) == 0);
-        eaRefMap::iterator colEnd = colMap.end();
+        msg(" type_info vftable not found.\n");
+        return(FALSE);
+    }
 
-		// Walk uint32 at the time, at align 4 (same for either 32bit or 64bit targets)
-        for (ea_t ptr = startEA; ptr < endEA; ptr += sizeof(UINT))
+    // Type descriptors and the COLs that point to them
+    UINT tdCount = 0, tdWithCol = 0;
+    qvector<ea_t> colEas;
+    for (size_t v = 0; v < learnedTiVftables.size(); v++)
+    {
+        const RefIndex::ref *tdFirst, *tdLast;
+        RefIndex::getRefsTo(learnedTiVftables[v], tdFirst, tdLast);
+        for (const RefIndex::ref *t = tdFirst; t != tdLast; t++)
         {
-            // A COL here?
-            ea_t ea = getEa(ptr);
-            eaRefMap::iterator it = colMap.find(ea);
-            if (it != colEnd)
+            ea_t td = t->getSource();
+            if (t->isRva() || !RTTI::type_info::isValid(td))
+                continue;
+            tdCount++;
+
+            // A COL 'typeDescriptor' is an RVA on 64bit, a pointer on 32bit
+            size_t before = colEas.size();
+            const RefIndex::ref *first, *last;
+            RefIndex::getRefsTo(td, first, last);
+            for (const RefIndex::ref *r = first; r != last; r++)
             {
-                // yes, look for vftable one ea_t below
-                ea_t vfptr  = (ptr + sizeof(ea_t));
-                ea_t method = getEa(vfptr);
+                #ifdef __EA64__
+                if (!r->isRva())
+                    continue;
+                #else
+                if (r->isRva())
+                    continue;
+                #endif
 
-                // Points to code?
-                if (segment_t *s = getseg(method))
-                {
-                    // yes,
-                    if (s->type == SEG_CODE)
-                    {
-						BOOL result =  RTTI::processVftable(vfptr, it->first);
-						//if(result)
-						//	msg(EAFORMAT " vft fix **\n", vfptr);
-						vftablesFixed += (UINT) result;
-                        it->second++, foundCount++;
-                    }
-                }
+                // Only the ones in the segments being scanned
+                ea_t col = (r->getSource() - offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
+                if (isCandidateEa(col) && RTTI::_RTTICompleteObjectLocator::isValid(col))
+                    colEas.push_back(col);
             }
+            if (colEas.size() > before)
+                tdWithCol++;
 
             if (WaitBox::isUpdateTime())
                 if (WaitBox::updateAndCancelCheck())
@@ -1430,103 +2131,572 @@ static BOOL scanSeg4Vftables(segment_t *seg, eaRefMap &colMap)
         }
     }
 
-    if (foundCount)
+    char numBuffer1[32], numBuffer2[32];
+    msg(" type_info vftables: %u, type descriptors: %s, with COL: %s\n", (UINT) learnedTiVftables.size(), prettyNumberString(tdCount, numBuffer1), prettyNumberString(tdWithCol, numBuffer2));
+    if ((tdWithCol == 0) || ((tdWithCol * 100) < (tdCount * REFS_MIN_COL_PERCENT)))
+    {
+        msg(" Reference graph too sparse, falling back to the segment scan.\n");
+        return(FALSE);
+    }
+    done = TRUE;
+
+    // Place the COLs in address order
+    std::sort(colEas.begin(), colEas.end());
+    colEas.resize(std::unique(colEas.begin(), colEas.end()) - colEas.begin());
+    for (size_t i = 0; i < colEas.size(); i++)
+    {
+        cols.add(colEas[i]);
+        missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(colEas[i]);
+    }
+    cols.seal();
+
+    return(findVftablesByRefs(cols));
+}
+
+// Seed from the COL (??_R4) and vftable (??_7) names already in the IDB, as left by IDA's own
+// RTTI analysis or a PDB. Places the COLs and outputs the vftables to process in address order.
+// Returns TRUE if aborted
+static BOOL seedFromNames(__out refTable &cols, __out qvector<VFTHIT> &vfts)
+{
+    size_t count = get_nlist_size();
+    for (size_t i = 0; i < count; i++)
+    {
+        LPCSTR name = get_nlist_name(i);
+        if (!name || (name[0] != '?') || (name[1] != '?') || (name[2] != '_'))
+            continue;
+
+        // Only the ones in the segments being scanned, their COLs can be anywhere
+        ea_t ea = get_nlist_ea(i);
+        if (!isCandidateEa(ea))
+            continue;
+
+        if (strncmp(name, "??_R4", SIZESTR("??_R4")) == 0)
+        {
+            if (RTTI::_RTTICompleteObjectLocator::isValid(ea))
+                cols.add(ea);
+        }
+        else
+        if (strncmp(name, "??_7", SIZESTR("??_7")) == 0)
+        {
+            // COL pointer right above it
+            ea_t slot = (ea - sizeof(ea_t));
+            ea_t col;
+            if (SegCache::getVerifyEa(slot, col) && SegCache::find(col) && RTTI::_RTTICompleteObjectLocator::isValid(col))
+            {
+                VFTHIT hit = { slot, col };
+                vfts.push_back(hit);
+                cols.add(col);
+            }
+        }
+
+        if (WaitBox::isUpdateTime())
+            if (WaitBox::updateAndCancelCheck())
+                return(TRUE);
+    }
+    cols.seal();
+
+    for (size_t i = 0; i < cols.size(); i++)
+        missingColsFixed += (UINT) RTTI::_RTTICompleteObjectLocator::tryStruct(cols.getEa(i));
+    return(FALSE);
+}
+
+// The bytes the named COLs and vftables take: each COL, and each vftable from its COL pointer
+// slot through its run of code pointers. Sorted and merged.
+static void getNamedExtents(const refTable &cols, const qvector<VFTHIT> &vfts, __out qvector<EARANGE> &extents)
+{
+    extents.clear();
+    for (size_t i = 0; i < cols.size(); i++)
+    {
+        EARANGE r = { cols.getEa(i), (cols.getEa(i) + sizeof(RTTI::_RTTICompleteObjectLocator)) };
+        extents.push_back(r);
+    }
+    for (qvector<VFTHIT>::const_iterator it = vfts.begin(), end = vfts.end(); it != end; ++it)
+    {
+        ea_t ea = (it->ptr + sizeof(ea_t));
+        if (const SegCache::snapshot *snap = SegCache::find(it->ptr))
+        {
+            while (((ea + sizeof(ea_t)) <= snap->end) && AddrIndex::isCode(snap->getEa(ea)))
+                ea += sizeof(ea_t);
+        }
+        EARANGE r = { it->ptr, ea };
+        extents.push_back(r);
+    }
+
+    std::sort(extents.begin(), extents.end(), [](const EARANGE &a, const EARANGE &b) { return(a.start < b.start); });
+    size_t count = 0;
+    for (size_t i = 0; i < extents.size(); i++)
+    {
+        if (count && (extents[i].start <= extents[count - 1].end))
+        {
+            if (extents[i].end > extents[count - 1].end)
+                extents[count - 1].end = extents[i].end;
+        }
+        else
+            extents[count++] = extents[i];
+    }
+    extents.resize(count);
+}
+
+// The parts of the segments 'extents' doesn't cover, before the first, between and after the last.
+// Leaves out gaps too small to hold a COL or a vftable.
+static void getScanGaps(qvector<segment_t *> &segs, const qvector<EARANGE> &extents, __out qvector<EARANGE> &gaps)
+{
+    gaps.clear();
+    const EARANGE *e = extents.begin(), *eEnd = extents.end();
+    for (size_t i = 0; i < segs.size(); i++)
+    {
+        ea_t cursor = segs[i]->start_ea, segEnd = segs[i]->end_ea;
+        for (; (e != eEnd) && (e->end <= cursor); e++);
+        for (; (e != eEnd) && (e->start < segEnd); e++)
+        {
+            if ((e->start > cursor) && ((e->start - cursor) >= (sizeof(ea_t) * 2)))
+            {
+                EARANGE r = { cursor, e->start };
+                gaps.push_back(r);
+            }
+            if (e->end > cursor)
+                cursor = e->end;
+            if (e->end > segEnd)
+                break;
+        }
+        if ((cursor < segEnd) && ((segEnd - cursor) >= (sizeof(ea_t) * 2)))
+        {
+            EARANGE r = { cursor, segEnd };
+            gaps.push_back(r);
+        }
+    }
+}
+
+// Locate COLs and their vftables in one pass over the sorted 'ranges' of the segments.
+// Starts from the COLs already in 'cols', skipping them.
+// Returns TRUE if aborted
+static BOOL scanColsAndVftables(qvector<segment_t *> &segs, const qvector<EARANGE> &ranges, __inout refTable &cols, __out UINT &resolved)
+{
+    qvector<SCANCHUNK> chunks;
+    const EARANGE *r = ranges.begin();
+    for (size_t i = 0; i < segs.size(); i++)
+    {
+        for (; (r != ranges.end()) && (r->start < segs[i]->start_ea); r++);
+        const EARANGE *first = r;
+        for (; (r != ranges.end()) && (r->start < segs[i]->end_ea); r++);
+        addScanChunks(segs[i], first, r, chunks);
+    }
+
+    UINT threads = Parallel::getThreadCount();
+    msg("Prefilter: %s, threads: %u\n", Simd::getLevelName(), threads);
+    #ifndef __EA64__
+    size_t fixupCount = 0;
+    UINT fixupSegs = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (chunks[i].useFixups)
+        {
+            fixupCount += chunks[i].fixups.size();
+            fixupSegs += (UINT) chunks[i].first;
+        }
+    }
+    if (fixupSegs)
     {
         char numBuffer[32];
-        msg(" Count: %s\n", prettyNumberString(foundCount, numBuffer));
+        msg("Relocated slots: %s, from %u of %u segments\n", prettyNumberString(fixupCount, numBuffer), fixupSegs, (UINT) segs.size());
     }
+    #endif
+
+    // Read only validation on the workers, placement back here on the main thread
+    SCANSTATE state;
+    state.nextEA = 0;
+    state.colFound = state.vftFound = state.vftKnown = 0;
+    state.cols.swap(cols);
+    BOOL aborted = Parallel::run(chunks.size(),
+        [&](size_t i) { analyzeScanChunk(chunks[i]); },
+        [&](size_t i) { return(commitScanChunk(chunks[i], state)); });
+    if (aborted)
+        return(TRUE);
+
+    cols.swap(state.cols);
+    cols.seal();
+    UINT processed;
+    if (processVftables(state.pending, cols, processed))
+        return(TRUE);
+    resolved += (processed - state.vftKnown);
     return(FALSE);
 }
 //
-static BOOL findVftables(SegSelect::segments *segList)
+// Locate COLs and their vftables: from their names, by following the references from the type_info vftable,
+// else by scanning the segments.
+// Only 'scanSegs' get scanned, the rest of 'segs' is there for the references into it.
+// 'completed' is set only if the scan ran to the end, not on abort or an exception.
+// Returns TRUE if aborted
+static BOOL findColsAndVftables(qvector<segment_t *> &segs, qvector<segment_t *> &scanSegs, __out BOOL &completed)
 {
+    completed = FALSE;
     try
     {
         TIMESTAMP startTime = getTimeStamp();
 
-        // COLs in a hash map for speed, plus add match counts
-        eaRefMap colMap;
-        for (eaList::const_iterator it = colList.begin(), end = colList.end(); it != end; ++it)
-            colMap[*it] = 0;
+        candidateRanges.clear();
+        for (size_t i = 0; i < scanSegs.size(); i++)
+        {
+            EARANGE r = { scanSegs[i]->start_ea, scanSegs[i]->end_ea };
+            candidateRanges.push_back(r);
+        }
+        partialScan = (scanSegs.size() < segs.size());
+
+        AddrIndex::build(segs);
+        #ifdef __EA64__
+        scanLo = scanHi = 0;
+        if (!segs.empty())
+        {
+            scanLo = segs.front()->start_ea;
+            scanHi = segs.back()->end_ea;
+        }
+        #else
+        getTypeInfoRanges(tdRanges);
+        scanRanges.clear();
+        for (size_t i = 0; i < segs.size(); i++)
+        {
+            if (!scanRanges.empty() && (scanRanges.back().hi == (UINT) segs[i]->start_ea))
+                scanRanges.back().hi = (UINT) segs[i]->end_ea;
+            else
+            {
+                Simd::range32 r = { (UINT) segs[i]->start_ea, (UINT) segs[i]->end_ea };
+                scanRanges.push_back(r);
+            }
+        }
+        #endif
+
+        // Who points where, for the name and reference walk modes
+        TIMESTAMP indexTime = getTimeStamp();
+        if (RefIndex::build(segs))
+            return(TRUE);
+        char numBuffer[32];
+        msg("Reference index: %s, time: %.3f\n", prettyNumberString(RefIndex::size(), numBuffer), (getTimeStamp() - indexTime));
+
+        // Function starts and bounds from the PE metadata, for the vftable method checks
+        PeInfo::load();
+        if (PeInfo::getFunctionCount() || PeInfo::getGuardTargetCount())
+        {
+            char numBuffer1[32], numBuffer2[32];
+            msg("PE metadata: %s .pdata functions, %s Guard CF targets\n", prettyNumberString(PeInfo::getFunctionCount(), numBuffer1), prettyNumberString(PeInfo::getGuardTargetCount(), numBuffer2));
+        }
+
+        // Analysis only queues its IDB edits, they get applied together afterwards
+        TIMESTAMP analysisTime = getTimeStamp();
+        EditQueue::begin();
+
+        refTable cols;
+        qvector<VFTHIT> namedVfts;
+        UINT resolved = 0;
+        if (seedFromNames(cols, namedVfts))
+            return(TRUE);
+
+        UINT namedCols = (UINT) cols.size();
+        if (namedCols)
+        {
+            // Only the gaps around the named COLs and vftables get scanned, for the unnamed rest
+            qvector<EARANGE> extents, gaps;
+            getNamedExtents(cols, namedVfts, extents);
+            getScanGaps(scanSegs, extents, gaps);
+            ea_t gapBytes = 0, segBytes = 0;
+            for (size_t i = 0; i < gaps.size(); i++)
+                gapBytes += (gaps[i].end - gaps[i].start);
+            for (size_t i = 0; i < scanSegs.size(); i++)
+                segBytes += scanSegs[i]->size();
+            msg("Discovery: names, gap scan of %s in %s ranges\n", byteSizeString(gapBytes), prettyNumberString(gaps.size(), numBuffer));
+
+            // The type descriptor index and the type_info vftables learned from it only pay off
+            // when most of the bytes still get scanned
+            if ((gapBytes * 2) > segBytes)
+            {
+                if (buildTypeInfoIndex())
+                    return(TRUE);
+                learnTypeInfoVftables();
+            }
+            if (scanColsAndVftables(scanSegs, gaps, cols, resolved))
+                return(TRUE);
+            UINT processed;
+            if (processVftables(namedVfts, cols, processed))
+                return(TRUE);
+        }
+        else
+        {
+            // Both the reference walk and the scan start from the type_info vftables
+            if (buildTypeInfoIndex())
+                return(TRUE);
+            learnTypeInfoVftables();
+
+            // The reference walk can't tell the COLs of the unchanged segments from the rest, so a rescan scans
+            BOOL done = FALSE;
+            if (!partialScan && findColsByRefs(cols, done))
+                return(TRUE);
+            if (done)
+                msg("Discovery: reference walk\n");
+            else
+            {
+                msg("Discovery: segment scan\n");
+                qvector<EARANGE> ranges;
+                for (size_t i = 0; i < scanSegs.size(); i++)
+                {
+                    EARANGE r = { scanSegs[i]->start_ea, scanSegs[i]->end_ea };
+                    ranges.push_back(r);
+                }
+                if (scanColsAndVftables(scanSegs, ranges, cols, resolved))
+                    return(TRUE);
+            }
+        }
+
+        TIMESTAMP commitTime = getTimeStamp();
+        size_t editCount = EditQueue::size();
+        if (EditQueue::apply())
+            return(TRUE);
+        msg("Analysis time: %.3f, commit: %s edits, time: %.3f\n", (commitTime - analysisTime), prettyNumberString(editCount, numBuffer), (getTimeStamp() - commitTime));
+
+        TIMESTAMP methodTime = getTimeStamp();
+        size_t methodCount = methodList.size();
+        if (createMethodFunctions())
+            return(TRUE);
+        if (methodCount)
+        {
+            char numBuffer1[32];
+            msg("Methods: %s slots, %s unique, time: %.3f\n", prettyNumberString(methodCount, numBuffer), prettyNumberString(uniqueMethods, numBuffer1), (getTimeStamp() - methodTime));
+        }
+
+        // Auto-analysis was off for the commit, let it catch up in one pass over the touched ranges.
+        // If the user had it off it stays off, the planned ranges and queued methods wait for them to turn it on.
+        TIMESTAMP reanalysisTime = getTimeStamp();
+        size_t rangeCount = EditQueue::resume();
+        if (EditQueue::wasAutoEnabled())
+            auto_wait();
+        TIMESTAMP endTime = getTimeStamp();
+        msg("Reanalysis: %s ranges, time: %.3f\n", prettyNumberString(rangeCount, numBuffer), (endTime - reanalysisTime));
+        msg("Time split: plugin %.3f, IDA reanalysis %.3f\n", (reanalysisTime - startTime), (endTime - reanalysisTime));
+
+        // Keep the COLs that were not located in 'colList'
+        colCount = (UINT) cols.size();
+        colList.clear();
+        UINT vftCount = 0;
+        for (size_t i = 0; i < cols.size(); i++)
+        {
+            if (cols.getRefs(i) == 0)
+                colList.push_front(cols.getEa(i));
+            else
+                vftCount += cols.getRefs(i);
+        }
+
+        char numBuffer1[32], numBuffer2[32];
+        msg("     Total COL: %s\n", prettyNumberString(colCount, numBuffer1));
+        msg(" Total vftable: %s (%s forward)\n", prettyNumberString(vftCount, numBuffer1), prettyNumberString(resolved, numBuffer2));
+        if (namedCols)
+        {
+            msg("    From names: %s COL, %s vftable\n", prettyNumberString(namedCols, numBuffer1), prettyNumberString((UINT) namedVfts.size(), numBuffer2));
+            msg(" From scanning: %s COL, %s vftable\n", prettyNumberString((colCount - namedCols), numBuffer1), prettyNumberString((vftCount - (UINT) namedVfts.size()), numBuffer2));
+        }
+        UINT64 hits, misses;
+        RTTI::getCacheStats(hits, misses);
+        msg("Validation cache: %s hits, %s misses\n", prettyNumberString(hits, numBuffer1), prettyNumberString(misses, numBuffer2));
+        RTTI::getChdStats(chdParsed, chdReused, chdTime);
+        msg("Scan time: %.3f\n", (getTimeStamp() - startTime));
+        completed = TRUE;
+    }
+    CATCH()
+    return(FALSE);
+}
+
+// ================================================================================================
+
+// Get the list of segments to scan
+static void getScanSegments(SegSelect::segments *segList, __out qvector<segment_t *> &segs)
+{
+	segs.clear();
+
+	// Use user selected segments
+	if (segList && !segList->empty())
+	{
+		for (SegSelect::segments::iterator it = segList->begin(); it != segList->end(); ++it)
+			segs.push_back(*it);
+	}
+	else
+	// Scan data segments named
+	{
+		int segCount = get_segm_qty();
+		for (int i = 0; i < segCount; i++)
+		{
+			if (segment_t *seg = getnseg(i))
+			{
+				if (seg->type == SEG_DATA)
+					segs.push_back(seg);
+			}
+		}
+	}
+
+	// Address order, the scan commits its results in that order
+	std::sort(segs.begin(), segs.end(), [](const segment_t *a, const segment_t *b) { return(a->start_ea < b->start_ea); });
+}
+
+// Bulk read the segments to scan so the scanners and validators can work from memory
+static void snapshotSegments(qvector<segment_t *> &segs)
+{
+	TIMESTAMP startTime = getTimeStamp();
+	UINT64 total = 0;
+
+	for (size_t i = 0; i < segs.size(); i++)
+	{
+		if (SegCache::add(segs[i]))
+			total += segs[i]->size();
+	}
+
+	msg("Segment snapshot: %s, time: %.3f\n", byteSizeString(total), (getTimeStamp() - startTime));
+}
+
+// Content hash the scanned segments
+static void hashSegments(const qvector<segment_t *> &segs, __out qvector<SEGHASH> &hashes)
+{
+	hashes.clear();
+	for (size_t i = 0; i < segs.size(); i++)
+	{
+		const SegCache::snapshot *snap = SegCache::find(segs[i]->start_ea);
+		if (snap && (snap->start == segs[i]->start_ea) && (snap->end == segs[i]->end_ea))
+		{
+			SEGHASH sh = { snap->start, snap->end, SegCache::hash(snap) };
+			hashes.push_back(sh);
+		}
+	}
+}
 
-		// Use user selected segments
-		if (segList && !segList->empty())
+// Keep the stored table entries of the segments that are the same as on the last run, and leave
+// just the changed ones in 'segs' to rescan. Resets the store with the kept entries.
+static void keepUnchangedSegments(__inout qvector<segment_t *> &segs, const qvector<SEGHASH> &hashes)
+{
+	// Unchanged if the bounds and hash match a stored record
+	qvector<SEGHASH> stored;
+	UINT count = getSegHashCount();
+	for (UINT i = 0; i < count; i++)
+	{
+		SEGHASH sh;
+		if (getSegHash(sh, i))
+			stored.push_back(sh);
+	}
+
+	qvector<EARANGE> unchanged;
+	for (size_t i = 0; i < hashes.size(); i++)
+	{
+		for (size_t j = 0; j < stored.size(); j++)
 		{
-			for (SegSelect::segments::iterator it = segList->begin(); it != segList->end(); ++it)
+			if ((hashes[i].start == stored[j].start) && (hashes[i].end == stored[j].end) && (hashes[i].hash == stored[j].hash))
 			{
-				if (scanSeg4Vftables(*it, colMap))
-					return(FALSE);
+				EARANGE r = { hashes[i].start, hashes[i].end };
+				unchanged.push_back(r);
+				break;
 			}
 		}
-		else
-		// Scan data segments named
+	}
+
+	// Their entries, in stored order
+	qvector<TBLENTRY> kept;
+	count = getTableCount();
+	for (UINT i = 0; i < count; i++)
+	{
+		TBLENTRY e;
+		if (getTableEntry(e, i))
 		{
-			int segCount = get_segm_qty();
-			for (int i = 0; i < segCount; i++)
+			for (size_t j = 0; j < unchanged.size(); j++)
 			{
-				if (segment_t *seg = getnseg(i))
+				if ((e.vft >= unchanged[j].start) && (e.vft < unchanged[j].end))
 				{
-					if (seg->type == SEG_DATA)
-					{
-						if (scanSeg4Vftables(seg, colMap))
-							return(FALSE);
-					}
+					kept.push_back(e);
+					break;
 				}
 			}
 		}
+	}
 
-        // Rebuild 'colList' with any that were not located
-        if (!colList.empty())
-        {
-			colCount = (UINT) colList.size();
-            colList.clear();
-
-            for (eaRefMap::const_iterator it = colMap.begin(), end = colMap.end(); it != end; ++it)
-            {
-                if (it->second == 0)
-                    colList.push_front(it->first);
-            }
+	newNetnodeStore();
+	for (size_t i = 0; i < kept.size(); i++)
+		putTableEntry(kept[i]);
+	reusedVftables = (UINT) kept.size();
+	reusedSegs = (UINT) unchanged.size();
 
-			//msg("\n** COLs not located: %u\n", (UINT)colList.size()); refreshUI();
-        }
+	// Rescan the rest. The unchanged ones keep their snapshots for the references into them.
+	for (size_t j = 0; j < unchanged.size(); j++)
+	{
+		for (size_t i = 0; i < segs.size(); i++)
+		{
+			if (segs[i]->start_ea == unchanged[j].start)
+			{
+				segs.erase(segs.begin() + i);
+				break;
+			}
+		}
+	}
 
-        msg("Vftable scan time: %.3f\n", (getTimeStamp() - startTime));
-    }
-    CATCH()
-    return(FALSE);
+	char numBuffer[32];
+	msg("Unchanged segments: %u of %u, kept %s vftables\n", reusedSegs, (UINT) hashes.size(), prettyNumberString(reusedVftables, numBuffer));
 }
 
+// Put the table back in vftable address order after merging the kept entries with the new ones
+static void sortTableEntries()
+{
+	UINT count = getTableCount();
+	qvector<TBLENTRY> entries;
+	entries.resize(count);
+	for (UINT i = 0; i < count; i++)
+		getTableEntry(entries[i], i);
+
+	std::sort(entries.begin(), entries.end(), [](const TBLENTRY &a, const TBLENTRY &b) { return(a.vft < b.vft); });
+	for (UINT i = 0; i < count; i++)
+		setTableEntry(entries[i], i);
+}
 
-// ================================================================================================
+// Store the scanned segment records for the next run
+static void putSegHashes(const qvector<SEGHASH> &hashes)
+{
+	netNode->supdel_all(NN_SEGS_TAG);
+	for (size_t i = 0; i < hashes.size(); i++)
+		netNode->supset((nodeidx_t) i, &hashes[i], sizeof(SEGHASH), NN_SEGS_TAG);
+	setSegHashCount((UINT) hashes.size());
+}
 
 // Gather RTTI data
 static BOOL getRttiData(SegSelect::segments *segList)
 {
     // Free RTTI working data on return
-    struct OnReturn  { ~OnReturn() { RTTI::freeWorkingData(); }; } onReturn;
+    struct OnReturn  { ~OnReturn() { RTTI::freeWorkingData(); freeScanData(); SegCache::clear(); }; } onReturn;
 
     try
     {
         // ==== Locate __type_info_root_node
         BOOL aborted = FALSE;
 
-        // ==== Find and process Complete Object Locators (COL)
-        msg("\nScanning for for RTTI Complete Object Locators..\n");
-		msg("-------------------------------------------------\n");
+        // ==== Pull the scan segment bytes in once
+        qvector<segment_t *> segs;
+        getScanSegments(segList, segs);
+        snapshotSegments(segs);
 
-        if(findCols(segList))
-            return(TRUE);
-        // typeDescList = TDs left that don't have a COL reference
-        // colList = Located COLs
+        // ==== Only rescan the segments that changed since the last run
+        qvector<SEGHASH> hashes;
+        hashSegments(segs, hashes);
+        qvector<segment_t *> scanSegs = segs;
+        if (rescanChanged)
+            keepUnchangedSegments(scanSegs, hashes);
 
-        // ==== Find and process vftables
-        msg("\nScanning for Virtual Function Tables..\n");
+        // ==== Find and process Complete Object Locators (COL) and their vftables
+        msg("\nScanning for RTTI Complete Object Locators and Virtual Function Tables..\n");
 		msg("-------------------------------------------------\n");
 
-        if(findVftables(segList))
-			return(TRUE);
+        BOOL completed = TRUE;
+        if (scanSegs.empty())
+            msg("No changed segments to scan.\n");
+        else
+        if(findColsAndVftables(segs, scanSegs, completed))
+            return(TRUE);
         // colList = COLs left that don't have a vft reference
 
+        if (reusedVftables)
+            sortTableEntries();
+        // A failed scan leaves no segment records, so the next rescan scans everything again
+        if (completed)
+            putSegHashes(hashes);
+
         // Could use the unlocated ref lists typeDescList & colList around for possible separate listing, etc.
         // They get cleaned up on return of this function anyhow.
     }
@@ -0,0 +1,112 @@
+
+// ****************************************************************************
+// File: NameCache.cpp
+// Desc: Run scoped mangled to plain type name cache
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "NameCache.h"
+#include "Arena.h"
+
+// Open addressing with linear probing, the strings in the arena
+struct SLOT
+{
+	LPCSTR mangled;	// NULL if empty
+	LPCSTR plain;
+	UINT hash;
+};
+
+static const UINT MIN_CAPACITY = 1024;
+
+static qvector<SLOT> slots;
+static UINT count = 0;
+static arena strings;
+static UINT64 hits = 0, misses = 0;
+
+// FNV-1a
+static UINT hashString(LPCSTR str, size_t &len)
+{
+	UINT hash = 2166136261;
+	LPCSTR p = str;
+	for (; *p; p++)
+		hash = ((hash ^ (BYTE) *p) * 16777619);
+	len = (size_t) (p - str);
+	return(hash);
+}
+
+// Slot holding 'mangled', or the empty one it would go in
+static SLOT &findSlot(LPCSTR mangled, UINT hash)
+{
+	UINT mask = ((UINT) slots.size() - 1);
+	for (UINT i = (hash & mask);; i = ((i + 1) & mask))
+	{
+		SLOT &slot = slots[i];
+		if (!slot.mangled || ((slot.hash == hash) && (strcmp(slot.mangled, mangled) == 0)))
+			return(slot);
+	}
+}
+
+// Double the table, keeping it under 3/4 full
+static void grow()
+{
+	qvector<SLOT> old;
+	old.swap(slots);
+	SLOT empty = { NULL, NULL, 0 };
+	slots.resize((old.empty() ? MIN_CAPACITY : (old.size() * 2)), empty);
+
+	for (size_t i = 0; i < old.size(); i++)
+	{
+		if (old[i].mangled)
+			findSlot(old[i].mangled, old[i].hash) = old[i];
+	}
+}
+
+LPCSTR NameCache::find(LPCSTR mangled)
+{
+	if (!slots.empty())
+	{
+		size_t len;
+		SLOT &slot = findSlot(mangled, hashString(mangled, len));
+		if (slot.mangled)
+		{
+			hits++;
+			return(slot.plain);
+		}
+	}
+
+	misses++;
+	return(NULL);
+}
+
+void NameCache::add(LPCSTR mangled, LPCSTR plain)
+{
+	if (((count + 1) * 4) > (slots.size() * 3))
+		grow();
+
+	size_t len;
+	UINT hash = hashString(mangled, len);
+	SLOT &slot = findSlot(mangled, hash);
+	if (!slot.mangled)
+	{
+		slot.mangled = strings.addString(mangled, len);
+		slot.plain = strings.addString(plain, strlen(plain));
+		slot.hash = hash;
+		count++;
+	}
+}
+
+void NameCache::clear()
+{
+	slots.clear();
+	strings.clear();
+	count = 0;
+	hits = misses = 0;
+}
+
+UINT NameCache::size() { return(count); }
+
+void NameCache::getStats(__out UINT64 &hitCount, __out UINT64 &missCount)
+{
+	hitCount = hits;
+	missCount = misses;
+}
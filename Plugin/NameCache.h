@@ -0,0 +1,19 @@
+
+// ****************************************************************************
+// File: NameCache.h
+// Desc: Run scoped mangled to plain type name cache
+//
+// ****************************************************************************
+#pragma once
+
+// The same base classes turn up in thousands of hierarchies, this has each type demangled once per run
+namespace NameCache
+{
+	// Plain name of 'mangled' if cached, else NULL
+	LPCSTR find(LPCSTR mangled);
+	void add(LPCSTR mangled, LPCSTR plain);
+	void clear();
+
+	UINT size();
+	void getStats(__out UINT64 &hits, __out UINT64 &misses);
+}
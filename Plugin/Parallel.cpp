@@ -0,0 +1,131 @@
+
+// ****************************************************************************
+// File: Parallel.cpp
+// Desc: Worker thread analysis with a serial commit stage
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Parallel.h"
+#include <WaitBoxEx.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+static const UINT MAX_THREADS = 32;
+static UINT threadCount = 0;
+
+void Parallel::setThreadCount(UINT count)
+{
+	threadCount = ((count > MAX_THREADS) ? MAX_THREADS : count);
+}
+
+UINT Parallel::getThreadCount()
+{
+	if (threadCount)
+		return(threadCount);
+
+	UINT count = std::thread::hardware_concurrency();
+	if (count == 0)
+		count = 1;
+	return((count > MAX_THREADS) ? MAX_THREADS : count);
+}
+
+BOOL Parallel::run(size_t count, ANALYZE analyze, COMMIT commit)
+{
+	UINT workers = getThreadCount();
+	if (workers > count)
+		workers = (UINT) count;
+
+	// Serial
+	if (workers <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			analyze(i);
+			if (commit(i))
+				return(TRUE);
+		}
+		return(FALSE);
+	}
+
+	// Workers take the next unit, the main thread commits them in order as they become ready
+	std::atomic<size_t> next(0);
+	std::atomic<bool> aborted(false);
+	std::mutex lock;
+	std::condition_variable readyEvent;
+	qvector<BYTE> ready;
+	ready.resize(count, FALSE);
+	// A unit's analysis exception, rethrown on the main thread instead of committing it
+	std::vector<std::exception_ptr> errors(count);
+
+	std::vector<std::thread> threads;
+	threads.reserve(workers);
+	for (UINT t = 0; t < workers; t++)
+	{
+		threads.push_back(std::thread([&]()
+		{
+			size_t i;
+			while (!aborted && ((i = next++) < count))
+			{
+				try
+				{
+					analyze(i);
+				}
+				catch (...)
+				{
+					// Never let an exception escape the thread
+					errors[i] = std::current_exception();
+					aborted = true;
+				}
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					ready[i] = TRUE;
+				}
+				readyEvent.notify_one();
+			}
+		}));
+	}
+
+	BOOL result = FALSE;
+	std::exception_ptr error;
+	for (size_t i = 0; (i < count) && !result; i++)
+	{
+		// Wait for it while keeping the UI alive
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			while (!ready[i])
+			{
+				readyEvent.wait_for(guard, std::chrono::milliseconds(50));
+				if (!ready[i])
+				{
+					guard.unlock();
+					if (WaitBox::isUpdateTime())
+						result = WaitBox::updateAndCancelCheck();
+					guard.lock();
+					if (result)
+						break;
+				}
+			}
+		}
+
+		if (result)
+			break;
+		if (errors[i])
+		{
+			error = errors[i];
+			break;
+		}
+		result = commit(i);
+	}
+
+	aborted = true;
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	if (error)
+		std::rethrow_exception(error);
+	return(result);
+}
@@ -0,0 +1,26 @@
+
+// ****************************************************************************
+// File: Parallel.h
+// Desc: Worker thread analysis with a serial commit stage
+//
+// ****************************************************************************
+#pragma once
+#include <functional>
+
+namespace Parallel
+{
+	// Runs on worker threads, must not touch the IDB
+	typedef std::function<void(size_t index)> ANALYZE;
+	// Runs on the main thread in index order, returns TRUE to abort
+	typedef std::function<BOOL(size_t index)> COMMIT;
+
+	// Zero means one per hardware thread
+	void setThreadCount(UINT count);
+	UINT getThreadCount();
+
+	// Analyze 'count' work units in parallel and commit each one in order as it completes.
+	// With one thread both stages simply run inline.
+	// An exception from an analysis stops the run before that unit gets committed and is rethrown here.
+	// Returns TRUE if aborted
+	BOOL run(size_t count, ANALYZE analyze, COMMIT commit);
+}
@@ -0,0 +1,155 @@
+
+// ****************************************************************************
+// File: PeInfo.cpp
+// Desc: PE function metadata: x64 exception directory and Control Flow Guard tables
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Main.h"
+#include "PeInfo.h"
+#include "SegCache.h"
+#include <algorithm>
+
+// Function [start, end) from a .pdata RUNTIME_FUNCTION entry
+struct FUNCRANGE
+{
+	ea_t start, end;
+};
+
+static qvector<FUNCRANGE> funcList;
+// Not every function: ILT thunks, code from objects built without /guard and some compiler thunks are left out
+static qvector<ea_t> guardList;
+
+// Load config directory Guard CF fields, past what older SDK headers declare
+#ifndef __EA64__
+typedef IMAGE_NT_HEADERS32 NTHEADERS;
+static const WORD NT_MAGIC = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+static const UINT LC_GUARD_TABLE = 0x50, LC_GUARD_COUNT = 0x54, LC_GUARD_FLAGS = 0x58;
+#else
+typedef IMAGE_NT_HEADERS64 NTHEADERS;
+static const WORD NT_MAGIC = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+static const UINT LC_GUARD_TABLE = 0x80, LC_GUARD_COUNT = 0x88, LC_GUARD_FLAGS = 0x90;
+#endif
+static const UINT GUARD_CF_FUNCTION_TABLE_PRESENT = 0x00000400;
+static const UINT GUARD_CF_FUNCTION_TABLE_SIZE_MASK = 0xF0000000;
+static const UINT GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT = 28;
+// UNWIND_INFO flag, the entry is a chunk of a function whose start is elsewhere
+static const BYTE UNW_FLAG_CHAININFO = 0x04;
+
+void PeInfo::clear()
+{
+	funcList.clear();
+	guardList.clear();
+}
+
+size_t PeInfo::getFunctionCount() { return(funcList.size()); }
+size_t PeInfo::getGuardTargetCount() { return(guardList.size()); }
+
+#ifdef __EA64__
+static void loadExceptionDirectory(ea_t imageBase, const IMAGE_DATA_DIRECTORY &dir)
+{
+	UINT count = (dir.Size / sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY));
+	if (!dir.VirtualAddress || !count)
+		return;
+
+	qvector<IMAGE_RUNTIME_FUNCTION_ENTRY> entries;
+	entries.resize(count);
+	if (!SegCache::read((imageBase + dir.VirtualAddress), entries.begin(), (count * sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY))))
+		return;
+
+	funcList.reserve(count);
+	for (UINT i = 0; i < count; i++)
+	{
+		const IMAGE_RUNTIME_FUNCTION_ENTRY &e = entries[i];
+		if (!e.BeginAddress || (e.EndAddress <= e.BeginAddress))
+			continue;
+
+		// Skip the chained entries, their start isn't a function start.
+		// UNWIND_INFO: version in the low 3 bits, flags in the high 5.
+		ea_t unwind = (imageBase + e.UnwindData);
+		if (SegCache::isLoaded(unwind) && ((SegCache::getByte(unwind) >> 3) & UNW_FLAG_CHAININFO))
+			continue;
+
+		FUNCRANGE r = { (imageBase + e.BeginAddress), (imageBase + e.EndAddress) };
+		funcList.push_back(r);
+	}
+
+	// Sorted by the spec, but don't count on it
+	std::sort(funcList.begin(), funcList.end(), [](const FUNCRANGE &a, const FUNCRANGE &b) { return(a.start < b.start); });
+}
+#endif
+
+static void loadGuardTable(ea_t imageBase, const IMAGE_DATA_DIRECTORY &dir)
+{
+	// The directory size isn't reliable for this one, the structure's own 'Size' is
+	if (!dir.VirtualAddress)
+		return;
+
+	ea_t config = (imageBase + dir.VirtualAddress);
+	UINT size = 0, flags = 0;
+	if (!SegCache::getVerify32(config, size) || (size < (LC_GUARD_FLAGS + sizeof(UINT))) || !SegCache::getVerify32((config + LC_GUARD_FLAGS), flags))
+		return;
+	if (!(flags & GUARD_CF_FUNCTION_TABLE_PRESENT))
+		return;
+
+	ea_t table = SegCache::getEa(config + LC_GUARD_TABLE);
+	ea_t count = SegCache::getEa(config + LC_GUARD_COUNT);
+	if (!table || (table == BADADDR) || !count || (count > (64 * 1024 * 1024)))
+		return;
+
+	// RVAs, each followed by optional metadata bytes
+	UINT stride = (sizeof(UINT) + ((flags & GUARD_CF_FUNCTION_TABLE_SIZE_MASK) >> GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT));
+	qvector<BYTE> bytes;
+	bytes.resize((size_t) (count * stride));
+	if (!SegCache::read(table, bytes.begin(), (UINT) bytes.size()))
+		return;
+
+	guardList.reserve((size_t) count);
+	for (size_t i = 0; i < (size_t) count; i++)
+		guardList.push_back(imageBase + *((PUINT) &bytes[i * stride]));
+	std::sort(guardList.begin(), guardList.end());
+}
+
+void PeInfo::load()
+{
+	clear();
+
+	// Stored by the PE loader as its NT headers copy
+	NTHEADERS nt;
+	netnode peNode("$ PE header");
+	if ((peNode == BADNODE) || (peNode.valobj(&nt, sizeof(nt)) < (ssize_t) sizeof(nt)))
+		return;
+	if ((nt.Signature != IMAGE_NT_SIGNATURE) || (nt.OptionalHeader.Magic != NT_MAGIC))
+		return;
+
+	ea_t imageBase = get_imagebase();
+	#ifdef __EA64__
+	if (nt.OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_EXCEPTION)
+		loadExceptionDirectory(imageBase, nt.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION]);
+	#endif
+	if (nt.OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG)
+		loadGuardTable(imageBase, nt.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG]);
+}
+
+static const FUNCRANGE *findFunction(ea_t ea)
+{
+	const FUNCRANGE *it = std::lower_bound(funcList.begin(), funcList.end(), ea, [](const FUNCRANGE &a, ea_t b) { return(a.start < b); });
+	if ((it != funcList.end()) && (it->start == ea))
+		return(it);
+	return(NULL);
+}
+
+PeInfo::RESULT PeInfo::checkFunction(ea_t ea)
+{
+	// A miss in either table proves nothing, the caller's own checks decide
+	if (std::binary_search(guardList.begin(), guardList.end(), ea) || findFunction(ea))
+		return(IS_FUNCTION);
+	return(UNSURE);
+}
+
+ea_t PeInfo::getFunctionEnd(ea_t ea)
+{
+	if (const FUNCRANGE *f = findFunction(ea))
+		return(f->end);
+	return(BADADDR);
+}
@@ -0,0 +1,29 @@
+
+// ****************************************************************************
+// File: PeInfo.h
+// Desc: PE function metadata: x64 exception directory and Control Flow Guard tables
+//
+// ****************************************************************************
+#pragma once
+
+namespace PeInfo
+{
+	// Load the tables from the PE header the loader kept in the IDB, once per run
+	void load();
+	void clear();
+
+	// Function starts from the exception directory (.pdata), chained entries excluded
+	size_t getFunctionCount();
+	// Valid indirect call targets from the Guard CF function table
+	size_t getGuardTargetCount();
+
+	enum RESULT
+	{
+		IS_FUNCTION,	// A function start in either table
+		UNSURE			// Not in a table, but they aren't complete enough to say no
+	};
+	RESULT checkFunction(ea_t ea);
+
+	// End of the function starting at 'ea' per .pdata, or BADADDR if unknown
+	ea_t getFunctionEnd(ea_t ea);
+}
@@ -8,6 +8,12 @@
 #include "Main.h"
 #include "RTTI.h"
 #include "Vftable.h"
+#include "SegCache.h"
+#include "EditQueue.h"
+#include "TypeName.h"
+#include "Intern.h"
+#include <atomic>
+#include <algorithm>
 
 // const Name::`vftable'
 static LPCSTR FORMAT_RTTI_VFTABLE = "??_7%s6B@";
@@ -27,33 +33,276 @@ static LPCSTR FORMAT_RTTI_COL_PREFIX = "??_R4";
 // Skip type_info tag for class/struct mangled name strings
 #define SKIP_TD_TAG(_str) ((_str) + SIZESTR(".?Ax"))
 
+// Record layouts for the target ABI, 32bit pointers or 64bit image relative offsets (RVAs)
+#ifndef __EA64__
+static_assert(sizeof(RTTI::_RTTICompleteObjectLocator) == 0x14, "x86 COL layout");
+static_assert(sizeof(RTTI::_RTTIClassHierarchyDescriptor) == 0x10, "x86 CHD layout");
+static_assert(sizeof(RTTI::_RTTIBaseClassDescriptor) == 0x18, "x86 BCD layout");
+static_assert(offsetof(RTTI::type_info, _M_d_name) == 0x08, "x86 type_info layout");
+// Resolve a record address field
+#define RESOLVE(_base, _field) ((ea_t) (_field))
+#else
+static_assert(sizeof(RTTI::_RTTICompleteObjectLocator) == 0x18, "x64 COL layout");
+static_assert(sizeof(RTTI::_RTTIClassHierarchyDescriptor) == 0x10, "x64 CHD layout");
+static_assert(sizeof(RTTI::_RTTIBaseClassDescriptor) == 0x18, "x64 BCD layout");
+static_assert(offsetof(RTTI::type_info, _M_d_name) == 0x10, "x64 type_info layout");
+#define RESOLVE(_base, _field) ((_base) + (UINT64) (_field))
+#endif
+
+// RTTI records read whole in one go, with their address fields resolved to absolute addresses.
+// 'colBase64' being the x64 RVA base from the owning COL, unused for 32bit.
+struct tdRecord
+{
+    RTTI::type_info raw;
+    ea_t name;
+
+    inline BOOL read(ea_t typeInfo)
+    {
+        name = (typeInfo + offsetof(RTTI::type_info, _M_d_name));
+        return(SegCache::read(typeInfo, &raw, offsetof(RTTI::type_info, _M_d_name)));
+    }
+};
+
+struct colRecord
+{
+    RTTI::_RTTICompleteObjectLocator raw;
+    ea_t colBase;
+    ea_t typeInfo;
+    ea_t chd;
+
+    inline BOOL read(ea_t col)
+    {
+        if (!SegCache::read(col, &raw, sizeof(raw)))
+            return(FALSE);
+        #ifndef __EA64__
+        colBase = 0;
+        #else
+        colBase = (col - (UINT64) raw.objectBase);
+        #endif
+        typeInfo = RESOLVE(colBase, raw.typeDescriptor);
+        chd = RESOLVE(colBase, raw.classDescriptor);
+        return(TRUE);
+    }
+};
+
+struct chdRecord
+{
+    RTTI::_RTTIClassHierarchyDescriptor raw;
+    ea_t baseClassArray;
+
+    inline BOOL read(ea_t chd, ea_t colBase64)
+    {
+        if (!SegCache::read(chd, &raw, sizeof(raw)))
+            return(FALSE);
+        baseClassArray = RESOLVE(colBase64, raw.baseClassArray);
+        return(TRUE);
+    }
+};
+
+struct bcdRecord
+{
+    RTTI::_RTTIBaseClassDescriptor raw;
+    ea_t typeInfo;
+
+    inline BOOL read(ea_t bcd, ea_t colBase64)
+    {
+        if (!SegCache::read(bcd, &raw, sizeof(raw)))
+            return(FALSE);
+        typeInfo = RESOLVE(colBase64, raw.typeDescriptor);
+        return(TRUE);
+    }
+};
+
 // Class name list container
 struct bcdInfo
 {
-    char m_name[496];
+    Intern::ID m_name;
     UINT m_attribute;
 	RTTI::PMD m_pmd;
+
+    inline LPCSTR getName() const { return(Intern::get(m_name)); }
 };
 typedef qvector<bcdInfo> bcdList;
 
 namespace RTTI
 {
-    void getBCDInfo(ea_t col, __out bcdList &nameList, __out UINT &numBaseClasses);
+    void getBCDInfo(const chdRecord &chd, ea_t colBase64, __out bcdList &nameList);
 };
 
 
-typedef std::unordered_map<ea_t, qstring> stringMap;
+// Interned strings read from the IDB, by address
+typedef std::unordered_map<ea_t, Intern::ID> stringMap;
 static stringMap stringCache;
-static eaSet tdSet;
-static eaSet chdSet;
-static eaSet bcdSet;
+
+// Parsed CHD, shared by every COL and vftable of the class.
+// A class with MI can have dozens of vftables, all walking the same BCD list.
+struct chdInfo
+{
+    bcdList list;
+    UINT numBaseClasses;
+    UINT attributes;
+    // Sorted (mdisp, first BCD index with it) pairs
+    qvector<std::pair<int, UINT>> mdispIndex;
+    // First BCD with a valid 'pdisp', or -1 if none
+    int firstPdisp;
+    // Hierarchy comment string per BCD index, rendered on first use
+    qvector<Intern::ID> hierarchy;
+};
+typedef std::unordered_map<ea_t, chdInfo> chdMap;
+static chdMap chdCache;
+// Parse counters and the time spent parsing and rendering, for the end stats
+static UINT chdParsed = 0;
+static UINT64 chdReused = 0;
+static double chdTime = 0.0;
+
+// Validation state per structure kind, address and, for the x64 RVA based kinds, the COL base it was checked with.
+// Failures are kept too, so a bad candidate reached again through another COL or BCD isn't redone.
+enum VKIND
+{
+    VK_TYPE_INFO,
+    VK_BCD,
+    VK_CHD,
+    VK_COUNT
+};
+enum VSTATE
+{
+    VS_VALID       = 1,
+    VS_INVALID     = 2,
+    VS_IN_PROGRESS = 4,
+    VS_PLACED      = 8  // Main thread only, structure placed
+};
+
+struct validKey
+{
+    ea_t ea, base;
+    inline bool operator==(const validKey &other) const { return((ea == other.ea) && (base == other.base)); }
+};
+struct validKeyHash
+{
+    inline size_t operator()(const validKey &key) const { return(std::hash<ea_t>()(key.ea ^ (key.base * (ea_t) 0x9E3779B97F4A7C15ull))); }
+};
+
+// Worker counts, added in as each worker thread ends
+static std::atomic<UINT64> workerHits(0), workerMisses(0);
+// Bumped when what a validation depends on changes, every thread's cache drops its results on next use
+static std::atomic<UINT> cacheGeneration(0);
+
+struct validCache
+{
+    // Node based, entry references stay put while nested validations insert
+    std::unordered_map<validKey, BYTE, validKeyHash> states[VK_COUNT];
+    // Per thread, so the validations don't all contend on shared counters
+    UINT64 hits, misses;
+    UINT generation;
+
+    validCache() : hits(0), misses(0), generation(0) {}
+    ~validCache() { flushStats(); }
+
+    inline BYTE &at(VKIND kind, ea_t ea, ea_t base = 0) { validKey key = { ea, base }; return(states[kind][key]); }
+    void clear()
+    {
+        for (int i = 0; i < VK_COUNT; i++)
+            states[i].clear();
+    }
+    void flushStats()
+    {
+        workerHits += hits;
+        workerMisses += misses;
+        hits = misses = 0;
+    }
+};
+
+// The main thread's, and one per worker for the life of the thread as they only see the snapshots
+static validCache mainCache;
+static thread_local validCache workerCache;
+
+// The sorted vftables a type descriptor's 'vfptr' can point to, empty until known
+static qvector<ea_t> typeInfoVftables;
+
+inline validCache &getCache()
+{
+    validCache &cache = (SegCache::isWorker() ? workerCache : mainCache);
+    if (cache.generation != cacheGeneration)
+    {
+        cache.clear();
+        cache.generation = cacheGeneration;
+    }
+    return(cache);
+}
+
+// Get validation result from cache, else run 'validate' and cache its result.
+// 'base' is the x64 COL base the structure's RVAs resolve from, zero if it has none.
+template <typename VALIDATE> static BOOL cachedValid(VKIND kind, ea_t ea, ea_t base, VALIDATE validate)
+{
+    validCache &cache = getCache();
+    BYTE &state = cache.at(kind, ea, base);
+    if (state & (VS_VALID | VS_INVALID))
+    {
+        cache.hits++;
+        return((state & VS_VALID) != 0);
+    }
+
+    // Referenced by its own validation
+    if (state & VS_IN_PROGRESS)
+        return(FALSE);
+
+    cache.misses++;
+    state |= VS_IN_PROGRESS;
+    UINT missCount = SegCache::getMissCount();
+    BOOL result = validate();
+    state &= ~VS_IN_PROGRESS;
+
+    // A worker's result that hit a snapshot miss isn't final, the main thread redoes it
+    if (SegCache::getMissCount() == missCount)
+        state |= (result ? VS_VALID : VS_INVALID);
+    return(result);
+}
+
+// Returns TRUE if the structure was already placed, else marks it placed
+static BOOL isPlaced(VKIND kind, ea_t ea)
+{
+    BYTE &state = getCache().at(kind, ea);
+    if (state & VS_PLACED)
+        return(TRUE);
+    state = (VS_PLACED | VS_VALID);
+    return(FALSE);
+}
+
+void RTTI::getCacheStats(__out UINT64 &hits, __out UINT64 &misses)
+{
+    hits = (workerHits + mainCache.hits);
+    misses = (workerMisses + mainCache.misses);
+}
+
+void RTTI::getChdStats(__out UINT &parsed, __out UINT64 &reused, __out double &time)
+{
+    parsed = chdParsed;
+    reused = chdReused;
+    time = chdTime;
+}
+
+void RTTI::setTypeInfoVftables(const qvector<ea_t> &vftables)
+{
+    typeInfoVftables = vftables;
+    std::sort(typeInfoVftables.begin(), typeInfoVftables.end());
+    // Results from before were checked against a different set
+    cacheGeneration++;
+}
 
 void RTTI::freeWorkingData()
 {
     stringCache.clear();
-    tdSet.clear();
-    chdSet.clear();
-    bcdSet.clear();
+    chdCache.clear();
+    chdParsed = 0;
+    chdReused = 0;
+    chdTime = 0.0;
+    Intern::clear();
+    mainCache.clear();
+    workerCache.clear();
+    mainCache.hits = mainCache.misses = 0;
+    workerHits = workerMisses = 0;
+    typeInfoVftables.clear();
+    cacheGeneration++;
 }
 
 // Mangle number for labeling
@@ -257,7 +506,7 @@ void RTTI::addDefinitionsToIda()
 // If it fails at least the fields should be set
 // 2.5: IDA 7 now has RTTI support; only place structs if don't exist at address
 // Returns TRUE if structure was placed, else it was already set
-static BOOL tryStructRTTI(ea_t ea, tid_t tid, __in_opt LPSTR typeName = NULL, BOOL bHasChd = FALSE)
+static BOOL placeStructRTTI(ea_t ea, tid_t tid, __in_opt LPSTR typeName, BOOL bHasChd)
 {
 	#define putDword(ea) create_dword(ea, sizeof(DWORD))
     #ifndef __EA64__
@@ -370,7 +619,7 @@ static BOOL tryStructRTTI(ea_t ea, tid_t tid, __in_opt LPSTR typeName = NULL, BO
 	if (tid == s_BaseClassDescriptor_ID)
 	{
 		// Recursive
-		tryStructRTTI(ea + offsetof(RTTI::_RTTIBaseClassDescriptor, pmd), s_PMD_ID);
+		placeStructRTTI(ea + offsetof(RTTI::_RTTIBaseClassDescriptor, pmd), s_PMD_ID, NULL, FALSE);
 
 		if (!hasName(ea))
 		{
@@ -411,17 +660,39 @@ static BOOL tryStructRTTI(ea_t ea, tid_t tid, __in_opt LPSTR typeName = NULL, BO
 	return FALSE;
 }
 
+// Place the struct now, or at commit time when the edit queue is active
+static BOOL tryStructRTTI(ea_t ea, tid_t tid, __in_opt LPSTR typeName = NULL, BOOL bHasChd = FALSE)
+{
+	if (EditQueue::isActive())
+	{
+		// Report what placing it now would, all the placement paths are conditional on the name
+		qstring name(typeName ? typeName : "");
+		BOOL hasTypeName = (typeName != NULL);
+		EditQueue::add(ea, [=]() { placeStructRTTI(ea, tid, (hasTypeName ? (LPSTR) name.c_str() : NULL), bHasChd); });
+		return(!hasName(ea));
+	}
+
+	return(placeStructRTTI(ea, tid, typeName, bHasChd));
+}
+
 
 // Read ASCII string from IDB at address
 static int getIdaString(ea_t ea, __out LPSTR buffer, int bufferSize)
 {
 	buffer[0] = 0;
 
+    // Worker threads only have the snapshots
+    if (SegCache::isWorker())
+    {
+        int len = SegCache::getString(ea, buffer, bufferSize);
+        return((len > 0) ? len : 0);
+    }
+
     // Return cached name if it exists
     stringMap::iterator it = stringCache.find(ea);
     if (it != stringCache.end())
     {
-        LPCSTR str = it->second.c_str();
+        LPCSTR str = Intern::get(it->second);
         int len = (int) strlen(str);
         if (len > bufferSize)
 			len = bufferSize;
@@ -430,8 +701,13 @@ static int getIdaString(ea_t ea, __out LPSTR buffer, int bufferSize)
     }
     else
     {
+        // Try the segment snapshot first
+        int len = SegCache::getString(ea, buffer, bufferSize);
+        if (len >= 0)
+            return len;
+
         // Read string at ea if it exists
-        int len = (int) get_max_strlit_length(ea, STRTYPE_C, ALOPT_IGNHEADS);
+        len = (int) get_max_strlit_length(ea, STRTYPE_C, ALOPT_IGNHEADS);
         if (len > 0)
         {
 			// Length includes terminator
@@ -449,7 +725,7 @@ static int getIdaString(ea_t ea, __out LPSTR buffer, int bufferSize)
                 // Cache it
 				memcpy(buffer, str.c_str(), len2);
                 buffer[len2] = 0;
-                stringCache[ea] = buffer;
+                stringCache[ea] = Intern::add(buffer, len2);
             }
             else
                 len = 0;
@@ -469,42 +745,71 @@ int RTTI::type_info::getName(ea_t typeInfo, __out LPSTR buffer, int bufferSize)
     return(getIdaString(typeInfo + offsetof(type_info, _M_d_name), buffer, bufferSize));
 }
 
+// Get interned type name, read once per type descriptor
+// Main thread only
+static Intern::ID getNameId(ea_t typeInfo)
+{
+    ea_t name = (typeInfo + offsetof(RTTI::type_info, _M_d_name));
+    stringMap::iterator it = stringCache.find(name);
+    if (it != stringCache.end())
+        return(it->second);
+
+    char buffer[MAXSTR];
+    Intern::ID id = Intern::EMPTY;
+    if (RTTI::type_info::getName(typeInfo, buffer, SIZESTR(buffer)) > 0)
+        id = Intern::add(buffer);
+    stringCache[name] = id;
+    return(id);
+}
+
 // A valid type_info/TypeDescriptor at pointer?
 BOOL RTTI::type_info::isValid(ea_t typeInfo)
 {
-    // TRUE if we've already seen it
-    if (tdSet.find(typeInfo) != tdSet.end())
-        return(TRUE);
-
-    if (is_loaded(typeInfo))
-	{
-		// Verify what should be a vftable
-        ea_t ea = getEa(typeInfo + offsetof(type_info, vfptr));
-        if (is_loaded(ea))
+    return(cachedValid(VK_TYPE_INFO, typeInfo, 0, [typeInfo]() -> BOOL
+    {
+        tdRecord td;
+        if (td.read(typeInfo))
 		{
-            // _M_data should be NULL statically
-            ea_t _M_data = BADADDR;
-            if (getVerifyEa((typeInfo + offsetof(type_info, _M_data)), _M_data))
-            {
-                if (_M_data == 0)
-                    return(isTypeName(typeInfo + offsetof(type_info, _M_d_name)));
-            }
+			// Verify what should be a vftable, one of the type_info ones once they're known
+            ea_t ea = td.raw.vfptr;
+            BOOL vftableOk;
+            if (typeInfoVftables.empty())
+                vftableOk = SegCache::isLoaded(ea);
+            else
+            if (typeInfoVftables.size() == 1)
+                vftableOk = (ea == typeInfoVftables[0]);
+            else
+                vftableOk = std::binary_search(typeInfoVftables.begin(), typeInfoVftables.end(), ea);
+            if (vftableOk)
+			{
+                // _M_data should be NULL statically
+                if (td.raw._M_data == 0)
+                    return(isTypeName(td.name));
+			}
 		}
-	}
 
-	return(FALSE);
+		return(FALSE);
+    }));
 }
 
 // Returns TRUE if known typename at address
 BOOL RTTI::type_info::isTypeName(ea_t name)
 {
     // Should start with a period
-    if (get_byte(name) == '.')
+    if (SegCache::getByte(name) == '.')
     {
         // Read the rest of the possible name string
         char buffer[MAXSTR];
         if (getIdaString(name, buffer, SIZESTR(buffer)))
         {
+            // Most are settled without demangling
+            switch (TypeName::recognize((buffer + 1) /*skip the '.'*/, (sizeof(buffer) - 1)))
+            {
+                case TypeName::IS_NAME:  return(TRUE);
+                case TypeName::NOT_NAME: return(FALSE);
+                default: break;
+            };
+
             // Should be valid if it properly demangles
             if (LPSTR s = __unDName(NULL, buffer+1 /*skip the '.'*/, 0, mallocWrap, free, (UNDNAME_32_BIT_DECODE | UNDNAME_TYPE_ONLY)))
             {
@@ -520,10 +825,8 @@ BOOL RTTI::type_info::isTypeName(ea_t name)
 void RTTI::type_info::tryStruct(ea_t typeInfo)
 {
 	// Only place once per address
-	if (tdSet.find(typeInfo) != tdSet.end())
+	if (isPlaced(VK_TYPE_INFO, typeInfo))
 		return;
-	else
-		tdSet.insert(typeInfo);
 
 	// Get type name
 	char name[MAXSTR];
@@ -553,57 +856,26 @@ void RTTI::type_info::tryStruct(ea_t typeInfo)
 // Return TRUE if address is a valid RTTI structure
 BOOL RTTI::_RTTICompleteObjectLocator::isValid(ea_t col)
 {
-    if (is_loaded(col))
+    colRecord r;
+    if (r.read(col))
     {
         // Check signature
-        UINT signature = -1;
-        if (getVerify32((col + offsetof(_RTTICompleteObjectLocator, signature)), signature))
+        #ifndef __EA64__
+        if (r.raw.signature == 0)
+        #else
+        // TODO: Can any of these be zero and still be valid?
+        if ((r.raw.signature == 1) && (r.raw.objectBase != 0) && (r.raw.typeDescriptor != 0) && (r.raw.classDescriptor != 0))
+        #endif
         {
-            #ifndef __EA64__
-            if (signature == 0)
+            // Check valid type_info
+            if (RTTI::type_info::isValid(r.typeInfo))
             {
-                // Check valid type_info
-                ea_t typeInfo = getEa(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-                if (RTTI::type_info::isValid(typeInfo))
+                if (RTTI::_RTTIClassHierarchyDescriptor::isValid(r.chd, r.colBase))
                 {
-                    ea_t classDescriptor = getEa(col + offsetof(_RTTICompleteObjectLocator, classDescriptor));
-                    if (RTTI::_RTTIClassHierarchyDescriptor::isValid(classDescriptor))
-                    {
-                        //msg(EAFORMAT" " EAFORMAT " " EAFORMAT " \n", col, typeInfo, classDescriptor);
-                        return(TRUE);
-                    }
+                    //msg(EAFORMAT" " EAFORMAT " " EAFORMAT " \n", col, r.typeInfo, r.chd);
+                    return(TRUE);
                 }
             }
-            #else
-            if (signature == 1)
-			{
-                // TODO: Can any of these be zero and still be valid?
-                UINT objectLocator = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, objectBase));
-                if (objectLocator != 0)
-                {
-                    UINT tdOffset = get_32bit(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-                    if (tdOffset != 0)
-                    {
-                        UINT cdOffset = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
-                        if (cdOffset != 0)
-                        {
-                            ea_t colBase = (col - (UINT64)objectLocator);
-
-                            ea_t typeInfo = (colBase + (UINT64)tdOffset);
-                            if (RTTI::type_info::isValid(typeInfo))
-                            {
-                                ea_t classDescriptor = (colBase + (UINT64) cdOffset);
-                                if (RTTI::_RTTIClassHierarchyDescriptor::isValid(classDescriptor, colBase))
-                                {
-                                    //msg(EAFORMAT" " EAFORMAT " " EAFORMAT " \n", col, typeInfo, classDescriptor);
-                                    return(TRUE);
-                                }
-                            }
-                        }
-                    }
-                }
-			}
-            #endif
 		}
 	}
 
@@ -615,16 +887,12 @@ BOOL RTTI::_RTTICompleteObjectLocator::isValid(ea_t col)
 BOOL RTTI::_RTTICompleteObjectLocator::isValid2(ea_t col)
 {
     // 'signature' should be zero
-    UINT signature = -1;
-    if (getVerify32((col + offsetof(_RTTICompleteObjectLocator, signature)), signature))
+    colRecord r;
+    if (r.read(col) && (r.raw.signature == 0))
     {
-        if (signature == 0)
-        {
-            // Verify CHD
-            ea_t classDescriptor = getEa(col + offsetof(_RTTICompleteObjectLocator, classDescriptor));
-            if (classDescriptor && (classDescriptor != BADADDR))
-                return(RTTI::_RTTIClassHierarchyDescriptor::isValid(classDescriptor));
-        }
+        // Verify CHD
+        if (r.chd && (r.chd != BADADDR))
+            return(RTTI::_RTTIClassHierarchyDescriptor::isValid(r.chd));
     }
 
     return(FALSE);
@@ -645,43 +913,34 @@ BOOL RTTI::_RTTICompleteObjectLocator::tryStruct(ea_t col)
 
 		tryStructRTTI(col, s_CompleteObjectLocator_ID);
 
-		#ifndef __EA64__
-		// Put type_def
-		ea_t typeInfo = getEa(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-		type_info::tryStruct(typeInfo);
-
-		// Place CHD hierarchy
-		ea_t classDescriptor = getEa(col + offsetof(_RTTICompleteObjectLocator, classDescriptor));
-		_RTTIClassHierarchyDescriptor::tryStruct(classDescriptor);
-		#else
-		UINT tdOffset = get_32bit(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-		UINT cdOffset = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
-		UINT objectLocator = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, objectBase));
-		ea_t colBase = (col - (UINT64)objectLocator);
-
-		ea_t typeInfo = (colBase + (UINT64)tdOffset);
-		type_info::tryStruct(typeInfo);
+		colRecord r;
+		if (r.read(col))
+		{
+			// Put type_def
+			type_info::tryStruct(r.typeInfo);
 
-		ea_t classDescriptor = (colBase + (UINT64)cdOffset);
-		_RTTIClassHierarchyDescriptor::tryStruct(classDescriptor, colBase);
+			// Place CHD hierarchy
+			_RTTIClassHierarchyDescriptor::tryStruct(r.chd, r.colBase);
 
-		// Set absolute address comments
-		ea_t ea = (col + offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
-		if (!hasComment(ea))
-		{
-			char buffer[64];
-			sprintf_s(buffer, sizeof(buffer), "0x" EAFORMAT, typeInfo);
-			setComment(ea, buffer, TRUE);
-		}
+			#ifdef __EA64__
+			// Set absolute address comments
+			ea_t ea = (col + offsetof(RTTI::_RTTICompleteObjectLocator, typeDescriptor));
+			if (!hasComment(ea))
+			{
+				char buffer[64];
+				sprintf_s(buffer, sizeof(buffer), "0x" EAFORMAT, r.typeInfo);
+				setComment(ea, buffer, TRUE);
+			}
 
-		ea = (col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
-		if (!hasComment(ea))
-		{
-			char buffer[64];
-			sprintf_s(buffer, sizeof(buffer), "0x" EAFORMAT, classDescriptor);
-			setComment(ea, buffer, TRUE);
+			ea = (col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
+			if (!hasComment(ea))
+			{
+				char buffer[64];
+				sprintf_s(buffer, sizeof(buffer), "0x" EAFORMAT, r.chd);
+				setComment(ea, buffer, TRUE);
+			}
+			#endif
 		}
-		#endif
 
 		return TRUE;
 	}
@@ -695,59 +954,40 @@ BOOL RTTI::_RTTICompleteObjectLocator::tryStruct(ea_t col)
 // Return TRUE if address is a valid BCD
 BOOL RTTI::_RTTIBaseClassDescriptor::isValid(ea_t bcd, ea_t colBase64)
 {
-    // TRUE if we've already seen it
-    if (bcdSet.find(bcd) != bcdSet.end())
-        return(TRUE);
-
-    if (is_loaded(bcd))
+    return(cachedValid(VK_BCD, bcd, colBase64, [bcd, colBase64]() -> BOOL
     {
-        // Check attributes flags first
-        UINT attributes = -1;
-        if (getVerify32((bcd + offsetof(_RTTIBaseClassDescriptor, attributes)), attributes))
+        bcdRecord r;
+        if (r.read(bcd, colBase64))
         {
-            // Valid flags are the lower byte only
-            if ((attributes & 0xFFFFFF00) == 0)
+            // Check attributes flags first, valid flags are the lower byte only
+            if ((r.raw.attributes & 0xFFFFFF00) == 0)
             {
                 // Check for valid type_info
-                #ifndef __EA64__
-                return(RTTI::type_info::isValid(getEa(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor))));
-                #else
-                UINT tdOffset = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-                ea_t typeInfo = (colBase64 + (UINT64) tdOffset);
-                return(RTTI::type_info::isValid(typeInfo));
-                #endif
+                return(RTTI::type_info::isValid(r.typeInfo));
             }
         }
-    }
 
-    return(FALSE);
+        return(FALSE);
+    }));
 }
 
 // Put BCD structure at address
 void RTTI::_RTTIBaseClassDescriptor::tryStruct(ea_t bcd, __out_bcount(MAXSTR) LPSTR baseClassName, ea_t colBase64)
 {
-    // Only place it once
-    if (bcdSet.find(bcd) != bcdSet.end())
+    bcdRecord r;
+    if (r.read(bcd, colBase64))
     {
-        // Seen already, just return type name
-        #ifndef __EA64__
-        ea_t typeInfo = getEa(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-        #else
-        UINT tdOffset = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-        ea_t typeInfo = (colBase64 + (UINT64) tdOffset);
-        #endif
-
-        char buffer[MAXSTR];
-        type_info::getName(typeInfo, buffer, SIZESTR(buffer));
-        strcpy_s(baseClassName, sizeof(buffer), SKIP_TD_TAG(buffer));
-        return;
-    }
-    else
-        bcdSet.insert(bcd);
+        // Only place it once
+        if (isPlaced(VK_BCD, bcd))
+        {
+            // Seen already, just return type name
+            char buffer[MAXSTR];
+            type_info::getName(r.typeInfo, buffer, SIZESTR(buffer));
+            strcpy_s(baseClassName, sizeof(buffer), SKIP_TD_TAG(buffer));
+            return;
+        }
 
-    if (is_loaded(bcd))
-    {
-        UINT attributes = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, attributes));
+        UINT attributes = r.raw.attributes;
         tryStructRTTI(bcd, s_BaseClassDescriptor_ID, NULL, ((attributes & BCD_HASPCHD) > 0));
 
         // Has appended CHD?
@@ -779,17 +1019,11 @@ void RTTI::_RTTIBaseClassDescriptor::tryStruct(ea_t bcd, __out_bcount(MAXSTR) LP
         }
 
         // Place type_info struct
-        #ifndef __EA64__
-        ea_t typeInfo = getEa(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-        #else
-        UINT tdOffset = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-        ea_t typeInfo = (colBase64 + (UINT64)tdOffset);
-        #endif
-        type_info::tryStruct(typeInfo);
+        type_info::tryStruct(r.typeInfo);
 
         // Get raw type/class name
         char buffer[MAXSTR];
-        type_info::getName(typeInfo, buffer, SIZESTR(buffer));
+        type_info::getName(r.typeInfo, buffer, SIZESTR(buffer));
         strcpy_s(baseClassName, sizeof(buffer), SKIP_TD_TAG(buffer));
 
         if (!optionPlaceStructs && attributes)
@@ -820,9 +1054,9 @@ void RTTI::_RTTIBaseClassDescriptor::tryStruct(ea_t bcd, __out_bcount(MAXSTR) LP
             ZeroMemory(buffer, sizeof(buffer));
             char buffer1[64] = { 0 }, buffer2[64] = { 0 }, buffer3[64] = { 0 }, buffer4[64] = { 0 };
             _snprintf_s(buffer, sizeof(buffer), SIZESTR(buffer), FORMAT_RTTI_BCD,
-                mangleNumber(get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, mdisp))), buffer1),
-                mangleNumber(get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, pdisp))), buffer2),
-                mangleNumber(get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, vdisp))), buffer3),
+                mangleNumber((UINT) r.raw.pmd.mdisp, buffer1),
+                mangleNumber((UINT) r.raw.pmd.pdisp, buffer2),
+                mangleNumber((UINT) r.raw.pmd.vdisp, buffer3),
                 mangleNumber(attributes, buffer4),
                 baseClassName);
 
@@ -839,58 +1073,31 @@ void RTTI::_RTTIBaseClassDescriptor::tryStruct(ea_t bcd, __out_bcount(MAXSTR) LP
 // Return true if address is a valid CHD structure
 BOOL RTTI::_RTTIClassHierarchyDescriptor::isValid(ea_t chd, ea_t colBase64)
 {
-    // TRUE if we've already seen it
-    if (chdSet.find(chd) != chdSet.end())
-        return(TRUE);
-
-    if (is_loaded(chd))
+    return(cachedValid(VK_CHD, chd, colBase64, [chd, colBase64]() -> BOOL
     {
-        // signature should be zero statically
-        UINT signature = -1;
-        if (getVerify32((chd + offsetof(_RTTIClassHierarchyDescriptor, signature)), signature))
+        chdRecord r;
+        if (r.read(chd, colBase64))
         {
-            if (signature == 0)
+            // signature should be zero statically
+            if (r.raw.signature == 0)
             {
-                // Check attributes flags
-                UINT attributes = -1;
-                if (getVerify32((chd + offsetof(_RTTIClassHierarchyDescriptor, attributes)), attributes))
+                // Check attributes flags, valid flags are the lower nibble only
+                if ((r.raw.attributes & 0xFFFFFFF0) == 0)
                 {
-                    // Valid flags are the lower nibble only
-                    if ((attributes & 0xFFFFFFF0) == 0)
+                    // Should have at least one base class
+                    if (r.raw.numBaseClasses >= 1)
                     {
-                        // Should have at least one base class
-                        UINT numBaseClasses = 0;
-                        if (getVerify32((chd + offsetof(_RTTIClassHierarchyDescriptor, numBaseClasses)), numBaseClasses))
-                        {
-                            if (numBaseClasses >= 1)
-                            {
-                                // Check the first BCD entry
-                                #ifndef __EA64__
-                                ea_t baseClassArray = getEa(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
-                                #else
-                                UINT baseClassArrayOffset = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
-                                ea_t baseClassArray = (colBase64 + (UINT64) baseClassArrayOffset);
-                                #endif
-
-                                if (is_loaded(baseClassArray))
-                                {
-                                    #ifndef __EA64__
-                                    ea_t baseClassDescriptor = getEa(baseClassArray);
-                                    return(RTTI::_RTTIBaseClassDescriptor::isValid(baseClassDescriptor));
-                                    #else
-                                    ea_t baseClassDescriptor = (colBase64 + (UINT64) get_32bit(baseClassArray));
-                                    return(RTTI::_RTTIBaseClassDescriptor::isValid(baseClassDescriptor, colBase64));
-                                    #endif
-                                }
-                            }
-                        }
+                        // Check the first BCD entry
+                        UINT entry;
+                        if (SegCache::read(r.baseClassArray, &entry, sizeof(entry)))
+                            return(RTTI::_RTTIBaseClassDescriptor::isValid(RESOLVE(colBase64, entry), colBase64));
                     }
                 }
             }
         }
-    }
 
-    return(FALSE);
+        return(FALSE);
+    }));
 }
 
 
@@ -898,18 +1105,17 @@ BOOL RTTI::_RTTIClassHierarchyDescriptor::isValid(ea_t chd, ea_t colBase64)
 void RTTI::_RTTIClassHierarchyDescriptor::tryStruct(ea_t chd, ea_t colBase64)
 {
     // Only place it once per address
-    if (chdSet.find(chd) != chdSet.end())
+    if (isPlaced(VK_CHD, chd))
         return;
-    else
-        chdSet.insert(chd);
 
-    if (is_loaded(chd))
+    chdRecord r;
+    if (r.read(chd, colBase64))
     {
         // Place CHD
         tryStructRTTI(chd, s_ClassHierarchyDescriptor_ID);
 
         // Place attributes comment
-        UINT attributes = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, attributes));
+        UINT attributes = r.raw.attributes;
         if (!optionPlaceStructs && attributes)
         {
 			ea_t ea = (chd + offsetof(_RTTIClassHierarchyDescriptor, attributes));
@@ -927,135 +1133,126 @@ void RTTI::_RTTIClassHierarchyDescriptor::tryStruct(ea_t chd, ea_t colBase64)
         }
 
         // ---- Place BCD's ----
-        UINT numBaseClasses = 0;
-        if (getVerify32((chd + offsetof(_RTTIClassHierarchyDescriptor, numBaseClasses)), numBaseClasses))
+        UINT numBaseClasses = r.raw.numBaseClasses;
+        ea_t baseClassArray = r.baseClassArray;
+
+        #ifdef __EA64__
+		ea_t ea = (chd + offsetof(RTTI::_RTTIClassHierarchyDescriptor, baseClassArray));
+		if (!hasComment(ea))
+		{
+			char buffer[MAXSTR];
+			_snprintf_s(buffer, sizeof(buffer), SIZESTR(buffer), "0x" EAFORMAT, baseClassArray);
+			setComment(ea, buffer, TRUE);
+		}
+        #endif
+
+        if (baseClassArray && (baseClassArray != BADADDR))
         {
-            // Get pointer
+            // Create offset string based on input digits
             #ifndef __EA64__
-            ea_t baseClassArray = getEa(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
+            char format[32];
+            if(numBaseClasses > 1)
+            {
+                int digits = (int) strlen(_itoa(numBaseClasses, format, 10));
+                if (digits > 1)
+                    _snprintf_s(format, sizeof(format), SIZESTR(format), "  BaseClass[%%0%dd]", digits);
+                else
+                    strcpy_s(format, sizeof(format), "  BaseClass[%d]");
+            }
             #else
-            UINT baseClassArrayOffset = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
-            ea_t baseClassArray = (colBase64 + (UINT64) baseClassArrayOffset);
-
-			ea_t ea = (chd + offsetof(RTTI::_RTTIClassHierarchyDescriptor, baseClassArray));
-			if (!hasComment(ea))
-			{
-				char buffer[MAXSTR];
-				_snprintf_s(buffer, sizeof(buffer), SIZESTR(buffer), "0x" EAFORMAT, baseClassArray);
-				setComment(ea, buffer, TRUE);
-			}
+            char format[128];
+            if (numBaseClasses > 1)
+            {
+                int digits = (int) strlen(_itoa(numBaseClasses, format, 10));
+                if (digits > 1)
+                    _snprintf_s(format, sizeof(format), SIZESTR(format), "  BaseClass[%%0%dd] 0x%%016I64X", digits);
+                else
+                    strcpy_s(format, sizeof(format), "  BaseClass[%d] 0x%016I64X");
+            }
             #endif
 
-            if (baseClassArray && (baseClassArray != BADADDR))
+            for (UINT i = 0; i < numBaseClasses; i++, baseClassArray += sizeof(UINT)) // sizeof(ea_t)
             {
-                // Create offset string based on input digits
                 #ifndef __EA64__
-                char format[32];
-                if(numBaseClasses > 1)
+                fixEa(baseClassArray);
+
+                // Add index comment to to it
+				if (!hasComment(baseClassArray))
                 {
-                    int digits = (int) strlen(_itoa(numBaseClasses, format, 10));
-                    if (digits > 1)
-                        _snprintf_s(format, sizeof(format), SIZESTR(format), "  BaseClass[%%0%dd]", digits);
+                    if (numBaseClasses == 1)
+                        setComment(baseClassArray, "  BaseClass", FALSE);
                     else
-                        strcpy_s(format, sizeof(format), "  BaseClass[%d]");
+                    {
+                        char ptrComent[MAXSTR];
+                        _snprintf_s(ptrComent, sizeof(ptrComent), SIZESTR(ptrComent), format, i);
+                        setComment(baseClassArray, ptrComent, false);
+                    }
                 }
+
+                // Place BCD struct, and grab the base class name
+                char baseClassName[MAXSTR];
+                _RTTIBaseClassDescriptor::tryStruct(getEa(baseClassArray), baseClassName);
                 #else
-                char format[128];
-                if (numBaseClasses > 1)
-                {
-                    int digits = (int) strlen(_itoa(numBaseClasses, format, 10));
-                    if (digits > 1)
-                        _snprintf_s(format, sizeof(format), SIZESTR(format), "  BaseClass[%%0%dd] 0x%%016I64X", digits);
-                    else
-                        strcpy_s(format, sizeof(format), "  BaseClass[%d] 0x%016I64X");
-                }
-                #endif
+                fixDword(baseClassArray);
+                UINT bcOffset = get_32bit(baseClassArray);
+                ea_t bcd = (colBase64 + (UINT64)bcOffset);
 
-                for (UINT i = 0; i < numBaseClasses; i++, baseClassArray += sizeof(UINT)) // sizeof(ea_t)
+                // Add index comment to to it
+				if (!hasComment(baseClassArray))
                 {
-                    #ifndef __EA64__
-                    fixEa(baseClassArray);
-
-                    // Add index comment to to it
-					if (!hasComment(baseClassArray))
+                    if (numBaseClasses == 1)
+                    {
+						char buffer[MAXSTR];
+                        sprintf_s(buffer, sizeof(buffer), "  BaseClass 0x" EAFORMAT, bcd);
+                        setComment(baseClassArray, buffer, FALSE);
+                    }
+                    else
                     {
-                        if (numBaseClasses == 1)
-                            setComment(baseClassArray, "  BaseClass", FALSE);
-                        else
-                        {
-                            char ptrComent[MAXSTR];
-                            _snprintf_s(ptrComent, sizeof(ptrComent), SIZESTR(ptrComent), format, i);
-                            setComment(baseClassArray, ptrComent, false);
-                        }
+						char buffer[MAXSTR];
+                        _snprintf_s(buffer, sizeof(buffer), SIZESTR(buffer), format, i, bcd);
+                        setComment(baseClassArray, buffer, false);
                     }
+                }
 
-                    // Place BCD struct, and grab the base class name
-                    char baseClassName[MAXSTR];
-                    _RTTIBaseClassDescriptor::tryStruct(getEa(baseClassArray), baseClassName);
-                    #else
-                    fixDword(baseClassArray);
-                    UINT bcOffset = get_32bit(baseClassArray);
-                    ea_t bcd = (colBase64 + (UINT64)bcOffset);
+                // Place BCD struct, and grab the base class name
+                char baseClassName[MAXSTR];
+                _RTTIBaseClassDescriptor::tryStruct(bcd, baseClassName, colBase64);
+                #endif
 
-                    // Add index comment to to it
-					if (!hasComment(baseClassArray))
+                // Now we have the base class name, name and label some things
+                if (i == 0)
+                {
+                    // Set array name
+                    if (!hasName(baseClassArray))
                     {
-                        if (numBaseClasses == 1)
-                        {
-							char buffer[MAXSTR];
-                            sprintf_s(buffer, sizeof(buffer), "  BaseClass 0x" EAFORMAT, bcd);
-                            setComment(baseClassArray, buffer, FALSE);
-                        }
-                        else
-                        {
-							char buffer[MAXSTR];
-                            _snprintf_s(buffer, sizeof(buffer), SIZESTR(buffer), format, i, bcd);
-                            setComment(baseClassArray, buffer, false);
-                        }
+                        // ??_R2A@@8 = A::`RTTI Base Class Array'
+                        char mangledName[MAXSTR];
+                        _snprintf_s(mangledName, sizeof(mangledName), SIZESTR(mangledName), FORMAT_RTTI_BCA, baseClassName);
+						setName(baseClassArray, mangledName);
                     }
 
-                    // Place BCD struct, and grab the base class name
-                    char baseClassName[MAXSTR];
-                    _RTTIBaseClassDescriptor::tryStruct(bcd, baseClassName, colBase64);
-                    #endif
+                    // Add a spacing comment line above us
+                    if (!hasAnteriorComment(baseClassArray))
+						setAnteriorComment(baseClassArray, "");
 
-                    // Now we have the base class name, name and label some things
-                    if (i == 0)
+                    // Set CHD name
+                    if (!hasName(chd))
                     {
-                        // Set array name
-                        if (!hasName(baseClassArray))
-                        {
-                            // ??_R2A@@8 = A::`RTTI Base Class Array'
-                            char mangledName[MAXSTR];
-                            _snprintf_s(mangledName, sizeof(mangledName), SIZESTR(mangledName), FORMAT_RTTI_BCA, baseClassName);
-							setName(baseClassArray, mangledName);
-                        }
-
-                        // Add a spacing comment line above us
-                        if (!hasAnteriorComment(baseClassArray))
-							setAnteriorComment(baseClassArray, "");
-
-                        // Set CHD name
-                        if (!hasName(chd))
-                        {
-                            // A::`RTTI Class Hierarchy Descriptor'
-                            char mangledName[MAXSTR];
-                            _snprintf_s(mangledName, sizeof(mangledName), SIZESTR(mangledName), FORMAT_RTTI_CHD, baseClassName);
-							setName(chd, mangledName);
-                        }
+                        // A::`RTTI Class Hierarchy Descriptor'
+                        char mangledName[MAXSTR];
+                        _snprintf_s(mangledName, sizeof(mangledName), SIZESTR(mangledName), FORMAT_RTTI_CHD, baseClassName);
+						setName(chd, mangledName);
                     }
                 }
+            }
 
-                // Make following DWORD if it's bytes are zeros
-                if (numBaseClasses > 0)
-                {
-                    if (is_loaded(baseClassArray))
-                        if (get_32bit(baseClassArray) == 0)
-                            fixDword(baseClassArray);
-                }
+            // Make following DWORD if it's bytes are zeros
+            if (numBaseClasses > 0)
+            {
+                if (is_loaded(baseClassArray))
+                    if (get_32bit(baseClassArray) == 0)
+                        fixDword(baseClassArray);
             }
-            else
-                _ASSERT(FALSE);
         }
         else
             _ASSERT(FALSE);
@@ -1069,69 +1266,112 @@ void RTTI::_RTTIClassHierarchyDescriptor::tryStruct(ea_t chd, ea_t colBase64)
 
 
 // Get list of base class descriptor info
-static void RTTI::getBCDInfo(ea_t col, __out bcdList &list, __out UINT &numBaseClasses)
+static void RTTI::getBCDInfo(const chdRecord &chd, ea_t colBase64, __out bcdList &list)
 {
-	numBaseClasses = 0;
+    UINT numBaseClasses = chd.raw.numBaseClasses;
+    if (numBaseClasses && chd.baseClassArray && (chd.baseClassArray != BADADDR))
+    {
+        // The whole base class array in one read
+        qvector<UINT> entries;
+        entries.resize(numBaseClasses);
+        if (SegCache::read(chd.baseClassArray, entries.begin(), (numBaseClasses * sizeof(UINT))))
+        {
+            list.resize(numBaseClasses);
+            for (UINT i = 0; i < numBaseClasses; i++)
+            {
+                bcdRecord r;
+                if (r.read(RESOLVE(colBase64, entries[i]), colBase64))
+                {
+                    // Add info to list
+                    bcdInfo *bi = &list[i];
+                    bi->m_name = getNameId(r.typeInfo);
+                    bi->m_pmd = r.raw.pmd;
+                    bi->m_attribute = r.raw.attributes;
 
-    #ifndef __EA64__
-    ea_t chd = getEa(col + offsetof(_RTTICompleteObjectLocator, classDescriptor));
-    #else
-    UINT cdOffset = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
-    UINT objectLocator = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, objectBase));
-    ea_t colBase = (col - (UINT64) objectLocator);
-    ea_t chd = (colBase + (UINT64) cdOffset);
-    #endif
+                    //msg("   BN: [%d] \"%s\", ATB: %04X\n", i, bi->getName(), bi->m_attribute);
+                    //msg("       mdisp: %d, pdisp: %d, vdisp: %d\n", bi->m_pmd.mdisp, bi->m_pmd.pdisp, bi->m_pmd.vdisp);
+                }
+            }
+        }
+    }
+}
 
-	if(chd)
-	{
-        if (numBaseClasses = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, numBaseClasses)))
-		{
-            list.resize(numBaseClasses);
 
-			// Get pointer
-            #ifndef __EA64__
-            ea_t baseClassArray = getEa(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
-            #else
-            UINT bcaOffset = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, baseClassArray));
-            ea_t baseClassArray = (colBase + (UINT64) bcaOffset);
-            #endif
+// Get the parsed CHD for a COL, parsing it on first use
+static chdInfo &getChdInfo(const colRecord &col)
+{
+    chdMap::iterator it = chdCache.find(col.chd);
+    if (it != chdCache.end())
+    {
+        chdReused++;
+        return(it->second);
+    }
 
-			if(baseClassArray && (baseClassArray != BADADDR))
-			{
-				for(UINT i = 0; i < numBaseClasses; i++, baseClassArray += sizeof(UINT)) // sizeof(ea_t)
-				{
-                    #ifndef __EA64__
-                    // Get next BCD
-                    ea_t bcd = getEa(baseClassArray);
-
-                    // Get type name
-                    ea_t typeInfo = getEa(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-                    #else
-                    UINT bcdOffset = get_32bit(baseClassArray);
-                    ea_t bcd = (colBase + (UINT64) bcdOffset);
-
-                    UINT tdOffset = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, typeDescriptor));
-                    ea_t typeInfo = (colBase + (UINT64) tdOffset);
-                    #endif
-                    bcdInfo *bi = &list[i];
-                    type_info::getName(typeInfo, bi->m_name, SIZESTR(bi->m_name));
-
-					// Add info to list
-                    UINT mdisp = get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, mdisp)));
-                    UINT pdisp = get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, pdisp)));
-                    UINT vdisp = get_32bit(bcd + (offsetof(_RTTIBaseClassDescriptor, pmd) + offsetof(PMD, vdisp)));
-                    // As signed int
-                    bi->m_pmd.mdisp = *((PINT) &mdisp);
-                    bi->m_pmd.pdisp = *((PINT) &pdisp);
-                    bi->m_pmd.vdisp = *((PINT) &vdisp);
-                    bi->m_attribute = get_32bit(bcd + offsetof(_RTTIBaseClassDescriptor, attributes));
-
-					//msg("   BN: [%d] \"%s\", ATB: %04X\n", i, szBuffer1, get_32bit((ea_t) &pBCD->attributes));
-					//msg("       mdisp: %d, pdisp: %d, vdisp: %d, attributes: %04X\n", *((PINT) &mdisp), *((PINT) &pdisp), *((PINT) &vdisp), attributes);
-				}
-			}
-		}
-	}
+    TIMESTAMP startTime = getTimeStamp();
+    chdInfo &ci = chdCache[col.chd];
+    ci.attributes = 0;
+    chdRecord chd;
+    if (chd.read(col.chd, col.colBase))
+    {
+        ci.attributes = chd.raw.attributes;
+        RTTI::getBCDInfo(chd, col.colBase, ci.list);
+    }
+    ci.numBaseClasses = (UINT) ci.list.size();
+
+    ci.firstPdisp = -1;
+    ci.mdispIndex.reserve(ci.numBaseClasses);
+    for (UINT i = 0; i < ci.numBaseClasses; i++)
+    {
+        ci.mdispIndex.push_back(std::make_pair(ci.list[i].m_pmd.mdisp, i));
+        if ((ci.firstPdisp == -1) && (ci.list[i].m_pmd.pdisp != -1))
+            ci.firstPdisp = (int) i;
+    }
+    // Ties order by index so the first match wins, same as a linear walk
+    std::sort(ci.mdispIndex.begin(), ci.mdispIndex.end());
+
+    ci.hierarchy.resize(ci.numBaseClasses, Intern::EMPTY);
+    chdParsed++;
+    chdTime += (getTimeStamp() - startTime);
+    return(ci);
+}
+
+// Get the first BCD index with member displacement 'mdisp', or -1 if none
+static int findMdisp(const chdInfo &ci, int mdisp)
+{
+    const std::pair<int, UINT> key(mdisp, 0);
+    qvector<std::pair<int, UINT>>::const_iterator it = std::lower_bound(ci.mdispIndex.begin(), ci.mdispIndex.end(), key);
+    if ((it != ci.mdispIndex.end()) && (it->first == mdisp))
+        return((int) it->second);
+    return(-1);
+}
+
+// Get hierarchy string starting with BCD 'index' followed by its forward children.
+// I.E. "Name: Base1, struct Base2;"
+static LPCSTR getHierarchy(chdInfo &ci, UINT index)
+{
+    Intern::ID &id = ci.hierarchy[index];
+    if (id == Intern::EMPTY)
+    {
+        TIMESTAMP startTime = getTimeStamp();
+        qstring cmt;
+        char plainName[MAXSTR];
+        for (UINT i = index; i < ci.numBaseClasses; i++)
+        {
+            LPCSTR name = ci.list[i].getName();
+            getPlainTypeName(name, plainName);
+            cmt.cat_sprnt(((i == index) ? "%s%s: " : "%s%s, "), ((name[3] == 'V') ? "" : "struct "), plainName);
+        }
+
+        // Nix the ending ',' for the last one
+        if ((index + 1) < ci.numBaseClasses)
+        {
+            cmt.remove((cmt.length() - 2), 2);
+            cmt += ';';
+        }
+        id = Intern::add(cmt.c_str());
+        chdTime += (getTimeStamp() - startTime);
+    }
+    return(Intern::get(id));
 }
 
 
@@ -1141,12 +1381,9 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
 {
 	BOOL result = FALSE;
 
-    #ifdef __EA64__
-    UINT tdOffset = get_32bit(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-    UINT objectLocator = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, objectBase));
-    ea_t colBase  = (col - (UINT64) objectLocator);
-    ea_t typeInfo = (colBase + (UINT64) tdOffset);
-    #endif
+    colRecord cr;
+    if (!cr.read(col))
+        return(FALSE);
 
     // Verify and fix if vftable exists here
     vftable::vtinfo vi;
@@ -1155,26 +1392,18 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
         //msg(EAFORMAT " - " EAFORMAT " c: %d\n", vi.start, vi.end, vi.methodCount);
 
 	    // Get COL type name
-        #ifndef __EA64__
-        ea_t typeInfo = getEa(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-        ea_t chd = get_32bit(col + offsetof(_RTTICompleteObjectLocator, classDescriptor));
-        #else
-        UINT cdOffset = get_32bit(col + offsetof(RTTI::_RTTICompleteObjectLocator, classDescriptor));
-        ea_t chd = (colBase + (UINT64) cdOffset);
-        #endif
-
-        char colName[MAXSTR];
-        type_info::getName(typeInfo, colName, SIZESTR(colName));
+        Intern::ID colNameId = getNameId(cr.typeInfo);
+        LPCSTR colName = Intern::get(colNameId);
         char demangledColName[MAXSTR];
         getPlainTypeName(colName, demangledColName);
 
-        UINT chdAttributes = get_32bit(chd + offsetof(_RTTIClassHierarchyDescriptor, attributes));
-        UINT offset = get_32bit(col + offsetof(_RTTICompleteObjectLocator, offset));
+        UINT offset = cr.raw.offset;
 
-	    // Parse BCD info
-	    bcdList list;
-        UINT numBaseClasses;
-	    getBCDInfo(col, list, numBaseClasses);
+	    // Parsed hierarchy, shared by all the COLs of the CHD
+	    chdInfo &ci = getChdInfo(cr);
+        UINT chdAttributes = ci.attributes;
+	    const bcdList &list = ci.list;
+        UINT numBaseClasses = ci.numBaseClasses;
 
         BOOL sucess = FALSE, isTopLevel = FALSE;
         qstring cmt;
@@ -1201,29 +1430,11 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
                 setName(col, decorated);
             }
 
-		    // Build object hierarchy string
-            int placed = 0;
+		    // Object hierarchy string
             if (numBaseClasses > 1)
             {
-                // Parent
-                char plainName[MAXSTR];
-                getPlainTypeName(list[0].m_name, plainName);
-                cmt.sprnt("%s%s: ", ((list[0].m_name[3] == 'V') ? "" : "struct "), plainName);
-                placed++;
-                isTopLevel = ((strcmp(list[0].m_name, colName) == 0) ? TRUE : FALSE);
-
-                // Child object hierarchy
-                for (UINT i = 1; i < numBaseClasses; i++)
-                {
-                    // Append name
-                    getPlainTypeName(list[i].m_name, plainName);
-                    cmt.cat_sprnt("%s%s, ", ((list[i].m_name[3] == 'V') ? "" : "struct "), plainName);
-                    placed++;
-                }
-
-                // Nix the ending ',' for the last one
-                if (placed > 1)
-                    cmt.remove((cmt.length() - 2), 2);
+                cmt = getHierarchy(ci, 0);
+                isTopLevel = ((list[0].m_name == colNameId) ? TRUE : FALSE);
             }
             else
             {
@@ -1232,57 +1443,39 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
                 isTopLevel = TRUE;
             }
 
-            if (placed > 1)
-                cmt += ';';
-
             sucess = TRUE;
 	    }
 	    // ======= Multiple inheritance, and, or, virtual inheritance hierarchies
         else
         {
-            bcdInfo *bi = NULL;
-            int index = 0;
+            int index = -1;
 
             // Must be the top level object for the type
             if (offset == 0)
             {
-                _ASSERT(strcmp(colName, list[0].m_name) == 0);
-                bi = &list[0];
+                _ASSERT(list[0].m_name == colNameId);
+                if (numBaseClasses)
+                    index = 0;
                 isTopLevel = TRUE;
             }
             else
             {
                 // Get our object BCD level by matching COL offset to displacement
-                for (UINT i = 0; i < numBaseClasses; i++)
-                {
-                    if (list[i].m_pmd.mdisp == offset)
-                    {
-                        bi = &list[i];
-                        index = i;
-                        break;
-                    }
-                }
+                index = findMdisp(ci, (int) offset);
 
                 // If not found in list, use the first base object instead
-                if (!bi)
+                if (index < 0)
                 {
                     //msg("** " EAFORMAT " MI COL class offset: %X(%d) not in BCD.\n", vft, offset, offset);
-                    for (UINT i = 0; i < numBaseClasses; i++)
-                    {
-                        if (list[i].m_pmd.pdisp != -1)
-                        {
-                            bi = &list[i];
-                            index = i;
-                            break;
-                        }
-                    }
+                    index = ci.firstPdisp;
                 }
             }
 
-            if (bi)
+            if (index >= 0)
             {
+                const bcdInfo *bi = &list[index];
+
                 // Top object level layout
-                int placed = 0;
                 if (isTopLevel)
                 {
                     // Set the vft name
@@ -1303,27 +1496,14 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
                         setName(col, decorated);
                     }
 
-                    // Build hierarchy string starting with parent
-                    char plainName[MAXSTR];
-                    getPlainTypeName(list[0].m_name, plainName);
-                    cmt.sprnt("%s%s: ", ((list[0].m_name[3] == 'V') ? "" : "struct "), plainName);
-                    placed++;
-
-                    // Concatenate forward child hierarchy
-                    for (UINT i = 1; i < numBaseClasses; i++)
-                    {
-                        getPlainTypeName(list[i].m_name, plainName);
-                        cmt.cat_sprnt("%s%s, ", ((list[i].m_name[3] == 'V') ? "" : "struct "), plainName);
-                        placed++;
-                    }
-                    if (placed > 1)
-                        cmt.remove((cmt.length() - 2), 2);
+                    // Hierarchy string starting with parent
+                    cmt = getHierarchy(ci, 0);
                 }
                 else
                 {
                     // Combine COL and CHD name
                     char combinedName[MAXSTR];
-                    _snprintf_s(combinedName, sizeof(combinedName), SIZESTR(combinedName), "%s6B%s@", SKIP_TD_TAG(colName), SKIP_TD_TAG(bi->m_name));
+                    _snprintf_s(combinedName, sizeof(combinedName), SIZESTR(combinedName), "%s6B%s@", SKIP_TD_TAG(colName), SKIP_TD_TAG(bi->getName()));
 
                     // Set vftable name
                     if (!hasName(vft))
@@ -1345,45 +1525,10 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
                         setName((ea_t) col, decorated);
                     }
 
-                    // Build hierarchy string starting with parent
-                    char plainName[MAXSTR];
-                    getPlainTypeName(bi->m_name, plainName);
-                    cmt.sprnt("%s%s: ", ((bi->m_name[3] == 'V') ? "" : "struct "), plainName);
-                    placed++;
-
-                    // Concatenate forward child hierarchy
-                    if (++index < (int) numBaseClasses)
-                    {
-                        for (; index < (int) numBaseClasses; index++)
-                        {
-                            getPlainTypeName(list[index].m_name, plainName);
-                            cmt.cat_sprnt("%s%s, ", ((list[index].m_name[3] == 'V') ? "" : "struct "), plainName);
-                            placed++;
-                        }
-                        if (placed > 1)
-                            cmt.remove((cmt.length() - 2), 2);
-                    }
-
-                    /*
-                    Experiment, maybe better this way to show before and after to show it's location in the hierarchy
-                    // Concatenate reverse child hierarchy
-                    if (--index >= 0)
-                    {
-                        for (; index >= 0; index--)
-                        {
-                            getPlainTypeName(list[index].m_name, plainName);
-                            cmt.cat_sprnt("%s%s, ", ((list[index].m_name[3] == 'V') ? "" : "struct "), plainName);
-                            placed++;
-                        }
-                        if (placed > 1)
-                            cmt.remove((cmt.length() - 2), 2);
-                    }
-                    */
+                    // Hierarchy string starting with our object, then its forward child hierarchy
+                    cmt = getHierarchy(ci, index);
                 }
 
-                if (placed > 1)
-                    cmt += ';';
-
                 sucess = TRUE;
             }
             else
@@ -1418,11 +1563,8 @@ BOOL RTTI::processVftable(ea_t vft, ea_t col)
         // Just set COL name
         if (!hasName(col))
         {
-            #ifndef __EA64__
-            ea_t typeInfo = getEa(col + offsetof(_RTTICompleteObjectLocator, typeDescriptor));
-            #endif
             char colName[MAXSTR];
-            type_info::getName(typeInfo, colName, SIZESTR(colName));
+            type_info::getName(cr.typeInfo, colName, SIZESTR(colName));
 
             char decorated[MAXSTR];
             _snprintf_s(decorated, sizeof(decorated), SIZESTR(decorated), FORMAT_RTTI_COL, SKIP_TD_TAG(colName));
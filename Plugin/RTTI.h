@@ -115,6 +115,13 @@ namespace RTTI
     const WORD IS_TOP_LEVEL = 0x8000;
 
     void freeWorkingData();
+    // Validation cache counters since the last freeWorkingData()
+    void getCacheStats(__out UINT64 &hits, __out UINT64 &misses);
+    // Parsed CHD counters since the last freeWorkingData(), 'time' being the total spent parsing and rendering
+    void getChdStats(__out UINT &parsed, __out UINT64 &reused, __out double &time);
+    // Once set, type_info::isValid() only accepts type descriptors pointing to one of these vftables.
+    // Drops the cached validation results. Call before any structure is placed.
+    void setTypeInfoVftables(const qvector<ea_t> &vftables);
 	void addDefinitionsToIda();
     BOOL processVftable(ea_t eaTable, ea_t col);
 }
@@ -0,0 +1,181 @@
+
+// ****************************************************************************
+// File: RefIndex.cpp
+// Desc: Pointer and RVA inverse index
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Main.h"
+#include "RefIndex.h"
+#include "SegCache.h"
+#include "Parallel.h"
+#include <WaitBoxEx.h>
+#include <algorithm>
+
+// Build work unit size
+static const ea_t BLOCK_SIZE = (256 * 1024);
+
+// Segment address range [start, end)
+struct SEGRANGE
+{
+	ea_t start, end;
+	BOOL code;
+};
+
+// Index block work unit
+struct REFBLOCK
+{
+	const SegCache::snapshot *snap;
+	ea_t start, end;
+	qvector<RefIndex::ref> refs;
+};
+
+// (target, source) pairs sorted by target then source
+static qvector<RefIndex::ref> refList;
+static BOOL built = FALSE;
+
+// Build state, read only on the workers
+static qvector<SEGRANGE> segRanges;
+static ea_t imageLo = 0, imageHi = 0;
+#ifdef __EA64__
+static ea_t imageBase = 0;
+#endif
+
+static const SEGRANGE *findRange(ea_t ea)
+{
+	if ((ea - imageLo) >= (imageHi - imageLo))
+		return(NULL);
+	const SEGRANGE *it = std::upper_bound(segRanges.begin(), segRanges.end(), ea, [](ea_t a, const SEGRANGE &b) { return(a < b.start); });
+	if ((it != segRanges.begin()) && (ea < (it - 1)->end))
+		return(it - 1);
+	return(NULL);
+}
+
+// Collect the references in a block
+// Runs on the worker threads, reads only from the segment snapshots
+static void analyzeBlock(REFBLOCK &block)
+{
+	const SegCache::snapshot *snap = block.snap;
+	for (ea_t ptr = block.start; ptr < block.end; ptr += sizeof(UINT))
+	{
+		if ((ptr + sizeof(ea_t)) <= snap->end)
+		{
+			ea_t value = snap->getEa(ptr);
+			if (findRange(value) && snap->isLoaded(ptr))
+			{
+				RefIndex::ref r = { value, ptr };
+				block.refs.push_back(r);
+			}
+		}
+
+		#ifdef __EA64__
+		// Only aligned ones into data, else every small integer in the image would be an RVA
+		UINT rva = snap->get32(ptr);
+		if (rva && !(rva & (sizeof(UINT) - 1)))
+		{
+			ea_t target = (imageBase + (ea_t) rva);
+			const SEGRANGE *range = findRange(target);
+			if (range && !range->code && snap->isLoaded(ptr))
+			{
+				RefIndex::ref r = { target, (ptr | RefIndex::ref::REF_RVA) };
+				block.refs.push_back(r);
+			}
+		}
+		#endif
+	}
+}
+
+BOOL RefIndex::build(const qvector<segment_t *> &segs)
+{
+	clear();
+
+	// Every segment is a valid target
+	int segCount = get_segm_qty();
+	for (int i = 0; i < segCount; i++)
+	{
+		if (segment_t *seg = getnseg(i))
+		{
+			SEGRANGE r = { seg->start_ea, seg->end_ea, (seg->type == SEG_CODE) };
+			segRanges.push_back(r);
+		}
+	}
+	if (!segRanges.empty())
+	{
+		imageLo = segRanges.front().start;
+		imageHi = segRanges.back().end;
+	}
+	#ifdef __EA64__
+	imageBase = get_imagebase();
+	#endif
+
+	qvector<REFBLOCK> blocks;
+	for (size_t i = 0; i < segs.size(); i++)
+	{
+		REFBLOCK block;
+		if (!(block.snap = SegCache::add(segs[i])))
+			continue;
+
+		ea_t startEA = ((segs[i]->start_ea + (sizeof(UINT) - 1)) & ~((ea_t) (sizeof(UINT) - 1)));
+		ea_t endEA   = (segs[i]->end_ea - (sizeof(UINT) - 1));
+		for (ea_t start = startEA; start < endEA; start += BLOCK_SIZE)
+		{
+			block.start = start;
+			block.end   = (((endEA - start) > BLOCK_SIZE) ? (start + BLOCK_SIZE) : endEA);
+			blocks.push_back(block);
+		}
+	}
+
+	BOOL aborted = Parallel::run(blocks.size(),
+		[&](size_t i) { analyzeBlock(blocks[i]); },
+		[&](size_t i) -> BOOL
+		{
+			refList.insert(refList.end(), blocks[i].refs.begin(), blocks[i].refs.end());
+			blocks[i].refs.clear();
+			if (WaitBox::isUpdateTime())
+				return(WaitBox::updateAndCancelCheck());
+			return(FALSE);
+		});
+	segRanges.clear();
+	if (aborted)
+	{
+		clear();
+		return(TRUE);
+	}
+
+	std::sort(refList.begin(), refList.end(), [](const ref &a, const ref &b) { return((a.target < b.target) || ((a.target == b.target) && (a.source < b.source))); });
+	built = TRUE;
+	return(FALSE);
+}
+
+void RefIndex::clear()
+{
+	refList.clear();
+	segRanges.clear();
+	built = FALSE;
+}
+
+BOOL RefIndex::isBuilt() { return(built); }
+size_t RefIndex::size() { return(refList.size()); }
+
+BOOL RefIndex::getRefsTo(ea_t target, __out const ref *&first, __out const ref *&last)
+{
+	first = std::lower_bound(refList.begin(), refList.end(), target, [](const ref &a, ea_t b) { return(a.target < b); });
+	last = first;
+	while ((last != refList.end()) && (last->target == target))
+		++last;
+	return(first != last);
+}
+
+BOOL RefIndex::isPointedTo(ea_t target)
+{
+	const ref *first, *last;
+	if (getRefsTo(target, first, last))
+	{
+		for (const ref *r = first; r != last; r++)
+		{
+			if (!r->isRva())
+				return(TRUE);
+		}
+	}
+	return(FALSE);
+}
@@ -0,0 +1,36 @@
+
+// ****************************************************************************
+// File: RefIndex.h
+// Desc: Pointer and RVA inverse index
+//
+// ****************************************************************************
+#pragma once
+
+namespace RefIndex
+{
+	// A slot holding a reference to 'target'
+	struct ref
+	{
+		enum { REF_RVA = 1 };
+
+		ea_t target;
+		ea_t source;	// Slot address, low bit set for a 32bit RVA rather than a pointer
+
+		inline ea_t getSource() const { return(source & ~((ea_t) REF_RVA)); }
+		inline BOOL isRva() const { return((BOOL) (source & REF_RVA)); }
+	};
+
+	// Build from the aligned slots of the (snapshotted) segments, once per run.
+	// Indexes every pointer sized value that lands inside a segment, and on 64bit every 32bit RVA
+	// that lands on an aligned address in a non-code segment.
+	// Returns TRUE if aborted
+	BOOL build(const qvector<segment_t *> &segs);
+	void clear();
+	BOOL isBuilt();
+	size_t size();
+
+	// References to 'target' as [first, last), sorted by source. Returns FALSE if none
+	BOOL getRefsTo(ea_t target, __out const ref *&first, __out const ref *&last);
+	// Has a pointer reference. The RVAs don't count, any data dword can look like one.
+	BOOL isPointedTo(ea_t target);
+}
@@ -0,0 +1,106 @@
+
+// ****************************************************************************
+// File: RefTable.cpp
+// Desc: Flat sorted address set with reference counts
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "RefTable.h"
+#include <algorithm>
+
+// Aim for about this many bitmap buckets per address, fewer false positives for more bitmap
+static const size_t BUCKETS_PER_EA = 8;
+// Minimum bucket size as a power of two, RTTI structures are at least this far apart
+static const UINT MIN_SHIFT = 3;
+
+void refTable::clear()
+{
+	eas.clear();
+	refs.clear();
+	bitmap.clear();
+	low = span = 0;
+	shift = 0;
+}
+
+void refTable::swap(refTable &other)
+{
+	eas.swap(other.eas);
+	refs.swap(other.refs);
+	bitmap.swap(other.bitmap);
+	std::swap(low, other.low);
+	std::swap(span, other.span);
+	std::swap(shift, other.shift);
+}
+
+void refTable::build(const eaList &list)
+{
+	clear();
+	eas.reserve(list.size());
+	for (eaList::const_iterator it = list.begin(), end = list.end(); it != end; ++it)
+		eas.push_back(*it);
+	std::sort(eas.begin(), eas.end());
+	eas.resize(std::unique(eas.begin(), eas.end()) - eas.begin());
+	refs.resize(eas.size(), 0);
+	seal();
+}
+
+// Add an address, cheap when they come in ascending order
+void refTable::add(ea_t ea)
+{
+	if (eas.empty() || (ea > eas.back()))
+	{
+		eas.push_back(ea);
+		refs.push_back(0);
+	}
+	else
+	{
+		ea_t *it = std::lower_bound(eas.begin(), eas.end(), ea);
+		if (*it == ea)
+			return;
+		size_t index = (it - eas.begin());
+		eas.insert(it, ea);
+		refs.insert(refs.begin() + index, 0);
+	}
+
+	// Bitmap is stale until the next seal()
+	bitmap.clear();
+	low  = eas.front();
+	span = ((eas.back() - low) + 1);
+}
+
+// Build the bitmap for the current address set
+void refTable::seal()
+{
+	bitmap.clear();
+	if (eas.empty())
+	{
+		low = span = 0;
+		return;
+	}
+
+	low  = eas.front();
+	span = ((eas.back() - low) + 1);
+
+	// Smallest bucket size that keeps the bitmap near the target density
+	size_t target = (eas.size() * BUCKETS_PER_EA);
+	shift = MIN_SHIFT;
+	while ((shift < ((sizeof(ea_t) * 8) - 1)) && ((size_t) ((span - 1) >> shift) >= target))
+		shift++;
+
+	size_t buckets = ((size_t) ((span - 1) >> shift) + 1);
+	bitmap.resize(((buckets + 31) / 32), 0);
+	for (size_t i = 0; i < eas.size(); i++)
+	{
+		size_t bucket = (size_t) ((eas[i] - low) >> shift);
+		bitmap[bucket >> 5] |= (1u << (bucket & 31));
+	}
+}
+
+// Bitmap hit, confirm with a binary search
+int refTable::search(ea_t ea) const
+{
+	const ea_t *it = std::lower_bound(eas.begin(), eas.end(), ea);
+	if ((it != eas.end()) && (*it == ea))
+		return((int) (it - eas.begin()));
+	return(-1);
+}
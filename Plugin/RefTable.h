@@ -0,0 +1,53 @@
+
+// ****************************************************************************
+// File: RefTable.h
+// Desc: Flat sorted address set with reference counts
+//
+// ****************************************************************************
+#pragma once
+
+// Sorted address array with a parallel ref count array and a range bitmap in front of it.
+// Built once, then queried for lots of mostly missing addresses: anything outside the
+// address span or landing in an empty bitmap bucket is rejected without touching the array.
+// Can also be grown one address at a time, lookups then skip the bitmap until sealed.
+class refTable
+{
+public:
+	refTable() : low(0), span(0), shift(0) {}
+
+	void build(const eaList &list);
+	void add(ea_t ea);
+	void seal();
+	void clear();
+	void swap(refTable &other);
+
+	// Index of 'ea', or -1 if not present
+	inline int find(ea_t ea) const
+	{
+		ea_t offset = (ea - low);
+		if (offset >= span)
+			return(-1);
+		if (!bitmap.empty())
+		{
+			size_t bucket = (size_t) (offset >> shift);
+			if (!(bitmap[bucket >> 5] & (1u << (bucket & 31))))
+				return(-1);
+		}
+		return(search(ea));
+	}
+
+	size_t size() const { return(eas.size()); }
+	BOOL empty() const { return(eas.empty()); }
+	ea_t getEa(size_t index) const { return(eas[index]); }
+	UINT getRefs(size_t index) const { return(refs[index]); }
+	void addRef(size_t index) { refs[index]++; }
+
+private:
+	int search(ea_t ea) const;
+
+	qvector<ea_t> eas;
+	qvector<UINT> refs;
+	qvector<UINT> bitmap;
+	ea_t low, span;
+	UINT shift;
+};
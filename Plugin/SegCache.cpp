@@ -0,0 +1,273 @@
+
+// ****************************************************************************
+// File: SegCache.cpp
+// Desc: Segment snapshot support
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Main.h"
+#include "SegCache.h"
+#include <algorithm>
+
+// Snapshots sorted by start address
+static qvector<SegCache::snapshot *> snapList;
+
+// Per thread state
+static thread_local const SegCache::snapshot *lastHit = NULL;
+static thread_local BOOL workerMode = FALSE;
+static thread_local UINT snapMiss = 0;
+
+SegCache::workerScope::workerScope() { workerMode = TRUE; snapMiss = 0; }
+SegCache::workerScope::~workerScope() { workerMode = FALSE; lastHit = NULL; }
+BOOL SegCache::isWorker() { return(workerMode); }
+void SegCache::clearMiss() { snapMiss = 0; }
+BOOL SegCache::hadMiss() { return(snapMiss != 0); }
+UINT SegCache::getMissCount() { return(snapMiss); }
+
+// Worker threads can't fall back to the IDB
+#define CHECK_WORKER(_result) { if (workerMode) { snapMiss++; return(_result); } }
+
+void SegCache::clear()
+{
+	for (size_t i = 0; i < snapList.size(); i++)
+		delete snapList[i];
+	snapList.clear();
+	lastHit = NULL;
+}
+
+// Bulk read segment bytes and loaded mask
+// Returns the snapshot, or NULL on failure
+const SegCache::snapshot *SegCache::add(segment_t *seg)
+{
+	// Already have it?
+	if (const snapshot *snap = find(seg->start_ea))
+	{
+		if ((snap->start == seg->start_ea) && (snap->end == seg->end_ea))
+			return(snap);
+	}
+
+	size_t size = (size_t) seg->size();
+	if (size == 0)
+		return(NULL);
+
+	snapshot *snap = new snapshot();
+	snap->start = seg->start_ea;
+	snap->end   = seg->end_ea;
+
+	// Pad the tail so unaligned ea_t reads at the end stay inside the buffer
+	snap->bytes.resize(size + sizeof(ea_t), 0xFF);
+	snap->mask.resize(((size + 7) / 8), 0);
+
+	ssize_t read = get_bytes(snap->bytes.begin(), size, seg->start_ea, GMB_READALL, snap->mask.begin());
+	if (read <= 0)
+	{
+		msg(EAFORMAT " ** SegCache::add(): bulk read failed! **\n", seg->start_ea);
+		delete snap;
+		return(NULL);
+	}
+
+	// Keep sorted for the binary search
+	qvector<snapshot *>::iterator it = std::upper_bound(snapList.begin(), snapList.end(), snap, [](const snapshot *a, const snapshot *b) { return(a->start < b->start); });
+	snapList.insert(it, snap);
+	return(snap);
+}
+
+// Get snapshot containing address, or NULL if none
+const SegCache::snapshot *SegCache::find(ea_t ea)
+{
+	// Same one as last time is by far the common case
+	if (lastHit && (ea >= lastHit->start) && (ea < lastHit->end))
+		return(lastHit);
+
+	qvector<snapshot *>::iterator it = std::upper_bound(snapList.begin(), snapList.end(), ea, [](ea_t a, const snapshot *b) { return(a < b->start); });
+	if (it != snapList.begin())
+	{
+		const snapshot *snap = *(it - 1);
+		if (ea < snap->end)
+			return(lastHit = snap);
+	}
+
+	return(NULL);
+}
+
+BOOL SegCache::isLoaded(ea_t ea)
+{
+	if (const snapshot *snap = find(ea))
+		return(snap->isLoaded(ea));
+	CHECK_WORKER(FALSE);
+	return(is_loaded(ea));
+}
+
+BYTE SegCache::getByte(ea_t ea)
+{
+	if (const snapshot *snap = find(ea))
+		return(*snap->ptr(ea));
+	CHECK_WORKER(0);
+	return((BYTE) get_byte(ea));
+}
+
+UINT SegCache::get32(ea_t ea)
+{
+	const snapshot *snap = find(ea);
+	if (snap && snap->contains(ea, sizeof(UINT)))
+		return(snap->get32(ea));
+	CHECK_WORKER(0);
+	return(get_32bit(ea));
+}
+
+ea_t SegCache::getEa(ea_t ea)
+{
+	const snapshot *snap = find(ea);
+	if (snap && snap->contains(ea, sizeof(ea_t)))
+		return(snap->getEa(ea));
+	CHECK_WORKER(0);
+	return(::getEa(ea));
+}
+
+BOOL SegCache::getVerify32(ea_t ea, UINT &value)
+{
+	if (isLoaded(ea))
+	{
+		value = get32(ea);
+		return(TRUE);
+	}
+	return(FALSE);
+}
+
+BOOL SegCache::getVerifyEa(ea_t ea, ea_t &value)
+{
+	if (isLoaded(ea))
+	{
+		value = getEa(ea);
+		return(TRUE);
+	}
+	return(FALSE);
+}
+
+BOOL SegCache::read(ea_t ea, __out_bcount(size) PVOID buffer, UINT size)
+{
+	const snapshot *snap = find(ea);
+	if (snap && snap->contains(ea, size))
+	{
+		for (UINT i = 0; i < size; i++)
+		{
+			if (!snap->isLoaded(ea + i))
+				return(FALSE);
+		}
+		memcpy(buffer, snap->ptr(ea), size);
+		return(TRUE);
+	}
+	CHECK_WORKER(FALSE);
+
+	// Without GMB_READALL it stops at the first unloaded byte
+	return(get_bytes(buffer, size, ea) == (ssize_t) size);
+}
+
+// Read a C string from the snapshot
+int SegCache::getString(ea_t ea, __out LPSTR buffer, int bufferSize)
+{
+	buffer[0] = 0;
+	const snapshot *snap = find(ea);
+	if (!snap)
+	{
+		if (workerMode)
+			snapMiss++;
+		return(-1);
+	}
+
+	// Must be terminated inside the segment and fit the buffer
+	ea_t end = snap->end;
+	if ((end - ea) > (ea_t) bufferSize)
+		end = (ea + bufferSize);
+
+	const BYTE *src = snap->ptr(ea);
+	int len = 0;
+	for (ea_t p = ea; p < end; p++, len++)
+	{
+		if (!snap->isLoaded(p))
+			return(0);
+
+		BYTE c = src[len];
+		if (c == 0)
+		{
+			memcpy(buffer, src, len);
+			buffer[len] = 0;
+			return(len);
+		}
+		else
+		// Type names are plain printable ASCII
+		if ((c < ' ') || (c > '~'))
+			return(0);
+	}
+
+	return(0);
+}
+
+// XXH64, see https://github.com/Cyan4973/xxHash
+static const UINT64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const UINT64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const UINT64 PRIME64_3 = 0x165667B19E3779F9ULL;
+static const UINT64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const UINT64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline UINT64 rotl64(UINT64 x, int r) { return((x << r) | (x >> (64 - r))); }
+static inline UINT64 read64(const BYTE *p) { UINT64 v; memcpy(&v, p, sizeof(v)); return(v); }
+static inline UINT   read32(const BYTE *p) { UINT v; memcpy(&v, p, sizeof(v)); return(v); }
+static inline UINT64 round64(UINT64 acc, UINT64 input) { return(rotl64((acc + (input * PRIME64_2)), 31) * PRIME64_1); }
+static inline UINT64 merge64(UINT64 acc, UINT64 val) { return(((acc ^ round64(0, val)) * PRIME64_1) + PRIME64_4); }
+
+static UINT64 xxh64(const BYTE *p, size_t len, UINT64 seed)
+{
+	const BYTE *end = (p + len);
+	UINT64 h;
+
+	if (len >= 32)
+	{
+		UINT64 v1 = (seed + PRIME64_1 + PRIME64_2);
+		UINT64 v2 = (seed + PRIME64_2);
+		UINT64 v3 = seed;
+		UINT64 v4 = (seed - PRIME64_1);
+		const BYTE *limit = (end - 32);
+		do
+		{
+			v1 = round64(v1, read64(p));
+			v2 = round64(v2, read64(p + 8));
+			v3 = round64(v3, read64(p + 16));
+			v4 = round64(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = (rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18));
+		h = merge64(h, v1);
+		h = merge64(h, v2);
+		h = merge64(h, v3);
+		h = merge64(h, v4);
+	}
+	else
+		h = (seed + PRIME64_5);
+
+	h += (UINT64) len;
+	for (; (p + 8) <= end; p += 8)
+		h = ((rotl64((h ^ round64(0, read64(p))), 27) * PRIME64_1) + PRIME64_4);
+	if ((p + 4) <= end)
+	{
+		h = ((rotl64((h ^ ((UINT64) read32(p) * PRIME64_1)), 23) * PRIME64_2) + PRIME64_3);
+		p += 4;
+	}
+	for (; p < end; p++)
+		h = (rotl64((h ^ (*p * PRIME64_5)), 11) * PRIME64_1);
+
+	h ^= (h >> 33);
+	h *= PRIME64_2;
+	h ^= (h >> 29);
+	h *= PRIME64_3;
+	h ^= (h >> 32);
+	return(h);
+}
+
+UINT64 SegCache::hash(const snapshot *snap)
+{
+	// The bytes without the tail padding, seeded by the loaded mask
+	UINT64 seed = xxh64(snap->mask.begin(), snap->mask.size(), 0);
+	return(xxh64(snap->bytes.begin(), (size_t) (snap->end - snap->start), seed));
+}
@@ -0,0 +1,56 @@
+
+// ****************************************************************************
+// File: SegCache.h
+// Desc: Segment snapshot support
+//
+// ****************************************************************************
+#pragma once
+
+namespace SegCache
+{
+	// Segment bytes and loaded mask pulled out of the IDB in one read
+	struct snapshot
+	{
+		ea_t start, end;
+		qvector<BYTE> bytes;
+		qvector<BYTE> mask;	// One bit per byte, set if the byte is loaded
+
+		inline BOOL contains(ea_t ea, UINT size = 1) const { return((ea >= start) && ((ea + size) <= end) && ((ea + size) > ea)); }
+		inline BOOL isLoaded(ea_t ea) const { size_t i = (size_t) (ea - start); return((mask[i >> 3] >> (i & 7)) & 1); }
+		inline const BYTE *ptr(ea_t ea) const { return(&bytes[(size_t) (ea - start)]); }
+		inline UINT get32(ea_t ea) const { return(*((PUINT) ptr(ea))); }
+		inline ea_t getEa(ea_t ea) const { return(*((ea_t *) ptr(ea))); }
+	};
+
+	const snapshot *add(segment_t *seg);
+	const snapshot *find(ea_t ea);
+	void clear();
+
+	// 64bit content hash (XXH64) of the snapshot bytes and loaded mask, to tell if a segment changed
+	UINT64 hash(const snapshot *snap);
+
+	// IDB accessor equivalents, served from the snapshots when possible
+	BOOL isLoaded(ea_t ea);
+	BYTE getByte(ea_t ea);
+	UINT get32(ea_t ea);
+	ea_t getEa(ea_t ea);
+	BOOL getVerify32(ea_t ea, UINT &value);
+	BOOL getVerifyEa(ea_t ea, ea_t &value);
+	// Read a whole record in one go, returns FALSE unless every byte of it is loaded
+	BOOL read(ea_t ea, __out_bcount(size) PVOID buffer, UINT size);
+	// Returns string length, zero if no string, or -1 if the address isn't covered
+	int  getString(ea_t ea, __out LPSTR buffer, int bufferSize);
+
+	// Worker thread mode: reads come from the snapshots only, never the IDB.
+	// A read that misses the snapshots is flagged so the caller can redo the work on the main thread.
+	struct workerScope
+	{
+		workerScope();
+		~workerScope();
+	};
+	BOOL isWorker();
+	void clearMiss();
+	BOOL hadMiss();
+	// Misses since the last clear, to tell if a result in between depended on one
+	UINT getMissCount();
+}
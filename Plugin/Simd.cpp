@@ -0,0 +1,355 @@
+
+// ****************************************************************************
+// File: Simd.cpp
+// Desc: Vectorized scan support
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "Simd.h"
+#include <immintrin.h>
+
+static Simd::LEVEL detectLevel()
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		if (info[0] >= 1)
+		{
+			__cpuid(info, 1);
+			if (info[2] & (1 << 19))
+				return(Simd::LEVEL_SSE41);
+		}
+		return(Simd::LEVEL_SCALAR);
+	}
+
+	__cpuid(info, 1);
+	BOOL sse41   = ((info[2] & (1 << 19)) != 0);
+	BOOL osxsave = ((info[2] & (1 << 27)) != 0);
+	BOOL avx     = ((info[2] & (1 << 28)) != 0);
+
+	// AVX2 needs the OS to save the YMM state too
+	if (osxsave && avx && ((_xgetbv(0) & 6) == 6))
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+			return(Simd::LEVEL_AVX2);
+	}
+
+	return(sse41 ? Simd::LEVEL_SSE41 : Simd::LEVEL_SCALAR);
+}
+
+static BOOL detectSse42()
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 1)
+		return(FALSE);
+	__cpuid(info, 1);
+	return((info[2] & (1 << 20)) != 0);
+}
+
+BOOL Simd::hasSse42()
+{
+	static BOOL sse42 = detectSse42();
+	return(sse42);
+}
+
+Simd::LEVEL Simd::getLevel()
+{
+	static LEVEL level = detectLevel();
+	return(level);
+}
+
+LPCSTR Simd::getLevelName()
+{
+	switch (getLevel())
+	{
+		case LEVEL_AVX2:  return("AVX2");
+		case LEVEL_SSE41: return("SSE4.1");
+		default:          return("scalar");
+	};
+}
+
+// Push the set bits of a lane mask as dword indexes
+inline void pushMask(UINT mask, UINT base, qvector<UINT> &indexes)
+{
+	while (mask)
+	{
+		unsigned long bit;
+		_BitScanForward(&bit, mask);
+		indexes.push_back(base + bit);
+		mask &= (mask - 1);
+	}
+}
+
+
+// --------------------------- x64 COL ---------------------------
+
+// Image bases are 64K aligned, so a COL's 'objectBase' has the same low 16 bits as its own address
+#define IMAGE_BASE_MASK 0xFFFF
+
+static void findColCandidates64Scalar(const UINT *data, size_t start, size_t count, UINT ea, qvector<UINT> &indexes)
+{
+	for (size_t i = start; i < count; i++)
+	{
+		if ((data[i] == 1) && ((((ea + (UINT) (i * sizeof(UINT))) - data[i + 5]) & IMAGE_BASE_MASK) == 0))
+			indexes.push_back((UINT) i);
+	}
+}
+
+static size_t findColCandidates64Sse41(const UINT *data, size_t count, UINT ea, qvector<UINT> &indexes)
+{
+	const __m128i one  = _mm_set1_epi32(1);
+	const __m128i mask = _mm_set1_epi32(IMAGE_BASE_MASK);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i step = _mm_set1_epi32(4 * sizeof(UINT));
+	__m128i self = _mm_setr_epi32(ea, (ea + 4), (ea + 8), (ea + 12));
+
+	size_t i = 0;
+	for (; (i + 4) <= count; i += 4)
+	{
+		__m128i sig  = _mm_loadu_si128((const __m128i *) &data[i]);
+		__m128i base = _mm_and_si128(_mm_sub_epi32(self, _mm_loadu_si128((const __m128i *) &data[i + 5])), mask);
+		__m128i hit  = _mm_and_si128(_mm_cmpeq_epi32(sig, one), _mm_cmpeq_epi32(base, zero));
+		if (!_mm_testz_si128(hit, hit))
+			pushMask((UINT) _mm_movemask_ps(_mm_castsi128_ps(hit)), (UINT) i, indexes);
+		self = _mm_add_epi32(self, step);
+	}
+	return(i);
+}
+
+static size_t findColCandidates64Avx2(const UINT *data, size_t count, UINT ea, qvector<UINT> &indexes)
+{
+	const __m256i one  = _mm256_set1_epi32(1);
+	const __m256i mask = _mm256_set1_epi32(IMAGE_BASE_MASK);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i step = _mm256_set1_epi32(8 * sizeof(UINT));
+	__m256i self = _mm256_setr_epi32(ea, (ea + 4), (ea + 8), (ea + 12), (ea + 16), (ea + 20), (ea + 24), (ea + 28));
+
+	size_t i = 0;
+	for (; (i + 8) <= count; i += 8)
+	{
+		__m256i sig  = _mm256_loadu_si256((const __m256i *) &data[i]);
+		__m256i base = _mm256_and_si256(_mm256_sub_epi32(self, _mm256_loadu_si256((const __m256i *) &data[i + 5])), mask);
+		__m256i hit  = _mm256_and_si256(_mm256_cmpeq_epi32(sig, one), _mm256_cmpeq_epi32(base, zero));
+		if (!_mm256_testz_si256(hit, hit))
+			pushMask((UINT) _mm256_movemask_ps(_mm256_castsi256_ps(hit)), (UINT) i, indexes);
+		self = _mm256_add_epi32(self, step);
+	}
+	_mm256_zeroupper();
+	return(i);
+}
+
+void Simd::findColCandidates64(const BYTE *data, size_t count, UINT ea, __out qvector<UINT> &indexes)
+{
+	const UINT *p = (const UINT *) data;
+	size_t done = 0;
+	switch (getLevel())
+	{
+		case LEVEL_AVX2:  done = findColCandidates64Avx2(p, count, ea, indexes);  break;
+		case LEVEL_SSE41: done = findColCandidates64Sse41(p, count, ea, indexes); break;
+	};
+	findColCandidates64Scalar(p, done, count, ea, indexes);
+}
+
+
+// --------------------------- x86 pointer ---------------------------
+
+static void findPtrCandidates32Scalar(const UINT *data, size_t start, size_t count, const Simd::range32 *ranges, size_t rangeCount, qvector<UINT> &indexes)
+{
+	UINT lo = ranges[0].lo, hi = ranges[rangeCount - 1].hi;
+	for (size_t i = start; i < count; i++)
+	{
+		UINT value = data[i];
+		if ((value >= lo) && (value < hi))
+		{
+			for (size_t j = 0; j < rangeCount; j++)
+			{
+				if ((value >= ranges[j].lo) && (value < ranges[j].hi))
+				{
+					indexes.push_back((UINT) i);
+					break;
+				}
+			}
+		}
+	}
+}
+
+// No unsigned dword compares before AVX-512, so bias both sides to signed
+#define BIAS32 0x80000000
+
+static size_t findPtrCandidates32Sse41(const UINT *data, size_t count, const Simd::range32 *ranges, size_t rangeCount, qvector<UINT> &indexes)
+{
+	const __m128i bias = _mm_set1_epi32(BIAS32);
+
+	size_t i = 0;
+	for (; (i + 4) <= count; i += 4)
+	{
+		__m128i value = _mm_xor_si128(_mm_loadu_si128((const __m128i *) &data[i]), bias);
+		__m128i hit = _mm_setzero_si128();
+		for (size_t j = 0; j < rangeCount; j++)
+		{
+			__m128i lo = _mm_set1_epi32(ranges[j].lo ^ BIAS32);
+			__m128i hi = _mm_set1_epi32(ranges[j].hi ^ BIAS32);
+			// lo <= value < hi
+			hit = _mm_or_si128(hit, _mm_andnot_si128(_mm_cmpgt_epi32(lo, value), _mm_cmpgt_epi32(hi, value)));
+		}
+		if (!_mm_testz_si128(hit, hit))
+			pushMask((UINT) _mm_movemask_ps(_mm_castsi128_ps(hit)), (UINT) i, indexes);
+	}
+	return(i);
+}
+
+static size_t findPtrCandidates32Avx2(const UINT *data, size_t count, const Simd::range32 *ranges, size_t rangeCount, qvector<UINT> &indexes)
+{
+	const __m256i bias = _mm256_set1_epi32(BIAS32);
+
+	size_t i = 0;
+	for (; (i + 8) <= count; i += 8)
+	{
+		__m256i value = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &data[i]), bias);
+		__m256i hit = _mm256_setzero_si256();
+		for (size_t j = 0; j < rangeCount; j++)
+		{
+			__m256i lo = _mm256_set1_epi32(ranges[j].lo ^ BIAS32);
+			__m256i hi = _mm256_set1_epi32(ranges[j].hi ^ BIAS32);
+			hit = _mm256_or_si256(hit, _mm256_andnot_si256(_mm256_cmpgt_epi32(lo, value), _mm256_cmpgt_epi32(hi, value)));
+		}
+		if (!_mm256_testz_si256(hit, hit))
+			pushMask((UINT) _mm256_movemask_ps(_mm256_castsi256_ps(hit)), (UINT) i, indexes);
+	}
+	_mm256_zeroupper();
+	return(i);
+}
+
+void Simd::findPtrCandidates32(const BYTE *data, size_t count, const range32 *ranges, size_t rangeCount, __out qvector<UINT> &indexes)
+{
+	if (rangeCount == 0)
+		return;
+
+	const UINT *p = (const UINT *) data;
+	size_t done = 0;
+	switch (getLevel())
+	{
+		case LEVEL_AVX2:  done = findPtrCandidates32Avx2(p, count, ranges, rangeCount, indexes);  break;
+		case LEVEL_SSE41: done = findPtrCandidates32Sse41(p, count, ranges, rangeCount, indexes); break;
+	};
+	findPtrCandidates32Scalar(p, done, count, ranges, rangeCount, indexes);
+}
+
+
+// --------------------------- Type names ---------------------------
+
+inline BOOL isTypeNamePrefix(const BYTE *p)
+{
+	return((p[0] == '.') && (p[1] == '?') && (p[2] == 'A') && ((p[3] == 'V') || (p[3] == 'U')));
+}
+
+static void findTypeNamesScalar(const BYTE *data, size_t start, size_t size, qvector<UINT> &offsets)
+{
+	for (size_t i = start; i < size; i++)
+	{
+		if (isTypeNamePrefix(data + i))
+			offsets.push_back((UINT) i);
+	}
+}
+
+// Compare each prefix byte at its own offset, a lane survives if all four match
+static size_t findTypeNamesSse41(const BYTE *data, size_t size, qvector<UINT> &offsets)
+{
+	const __m128i dot  = _mm_set1_epi8('.');
+	const __m128i mark = _mm_set1_epi8('?');
+	const __m128i a    = _mm_set1_epi8('A');
+	const __m128i v    = _mm_set1_epi8('V');
+	const __m128i u    = _mm_set1_epi8('U');
+
+	size_t i = 0;
+	for (; (i + 16) <= size; i += 16)
+	{
+		__m128i hit = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) &data[i]), dot);
+		if (_mm_testz_si128(hit, hit))
+			continue;
+		hit = _mm_and_si128(hit, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) &data[i + 1]), mark));
+		hit = _mm_and_si128(hit, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) &data[i + 2]), a));
+		__m128i kind = _mm_loadu_si128((const __m128i *) &data[i + 3]);
+		hit = _mm_and_si128(hit, _mm_or_si128(_mm_cmpeq_epi8(kind, v), _mm_cmpeq_epi8(kind, u)));
+		if (!_mm_testz_si128(hit, hit))
+			pushMask((UINT) _mm_movemask_epi8(hit), (UINT) i, offsets);
+	}
+	return(i);
+}
+
+static size_t findTypeNamesAvx2(const BYTE *data, size_t size, qvector<UINT> &offsets)
+{
+	const __m256i dot  = _mm256_set1_epi8('.');
+	const __m256i mark = _mm256_set1_epi8('?');
+	const __m256i a    = _mm256_set1_epi8('A');
+	const __m256i v    = _mm256_set1_epi8('V');
+	const __m256i u    = _mm256_set1_epi8('U');
+
+	size_t i = 0;
+	for (; (i + 32) <= size; i += 32)
+	{
+		__m256i hit = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) &data[i]), dot);
+		if (_mm256_testz_si256(hit, hit))
+			continue;
+		hit = _mm256_and_si256(hit, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) &data[i + 1]), mark));
+		hit = _mm256_and_si256(hit, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) &data[i + 2]), a));
+		__m256i kind = _mm256_loadu_si256((const __m256i *) &data[i + 3]);
+		hit = _mm256_and_si256(hit, _mm256_or_si256(_mm256_cmpeq_epi8(kind, v), _mm256_cmpeq_epi8(kind, u)));
+		if (!_mm256_testz_si256(hit, hit))
+			pushMask((UINT) _mm256_movemask_epi8(hit), (UINT) i, offsets);
+	}
+	_mm256_zeroupper();
+	return(i);
+}
+
+void Simd::findTypeNames(const BYTE *data, size_t size, __out qvector<UINT> &offsets)
+{
+	size_t done = 0;
+	switch (getLevel())
+	{
+		case LEVEL_AVX2:  done = findTypeNamesAvx2(data, size, offsets);  break;
+		case LEVEL_SSE41: done = findTypeNamesSse41(data, size, offsets); break;
+	};
+	findTypeNamesScalar(data, done, size, offsets);
+}
+
+
+// --------------------------- Mangled name characters ---------------------------
+
+inline BOOL isNameChar(char c)
+{
+	return(((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')) || (c == '_') || (c == '@') || (c == '?') || (c == '$'));
+}
+
+// One string compare per 16 chars, the range match stops on both an outside char and the terminator
+static size_t spanNameCharsSse42(LPCSTR str, size_t size)
+{
+	static const char ranges[16] = { 'A','Z', 'a','z', '0','9', '_','_', '@','@', '?','?', '$','$', 0,0 };
+	const __m128i set = _mm_loadu_si128((const __m128i *) ranges);
+
+	size_t i = 0;
+	for (; (i + 16) <= size; i += 16)
+	{
+		int index = _mm_cmpistri(set, _mm_loadu_si128((const __m128i *) &str[i]), (_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT));
+		if (index < 16)
+			return(i + index);
+	}
+	return(i);
+}
+
+size_t Simd::spanNameChars(LPCSTR str, size_t size)
+{
+	size_t i = 0;
+	if (hasSse42())
+	{
+		i = spanNameCharsSse42(str, size);
+		if ((i + 16) <= size)
+			return(i);
+	}
+
+	for (; (i < size) && isNameChar(str[i]); i++);
+	return(i);
+}
@@ -0,0 +1,49 @@
+
+// ****************************************************************************
+// File: Simd.h
+// Desc: Vectorized scan support
+//
+// ****************************************************************************
+#pragma once
+
+namespace Simd
+{
+	// Unsigned 32bit address range [lo, hi)
+	struct range32
+	{
+		UINT lo, hi;
+	};
+
+	// Best instruction set available, picked once at runtime
+	enum LEVEL
+	{
+		LEVEL_SCALAR,
+		LEVEL_SSE41,
+		LEVEL_AVX2
+	};
+	LEVEL getLevel();
+	LPCSTR getLevelName();
+	// String compare instructions, separate from the levels as SSE4.1 doesn't imply them
+	BOOL hasSse42();
+
+	// x64 COL prefilter over an aligned run of 'count' dwords at 'data'.
+	// Outputs the dword index of every lane where the COL 'signature' is one and the 'objectBase'
+	// five dwords on is the lane's own RVA from some 64K aligned image base; 'ea' being the low dword
+	// of the first dword's address.
+	// 'data' must be readable for (count + 5) dwords.
+	void findColCandidates64(const BYTE *data, size_t count, UINT ea, __out qvector<UINT> &indexes);
+
+	// x86 pointer prefilter over 'count' dwords at 'data'.
+	// Outputs the dword index of every value that falls inside one of the sorted 'ranges'.
+	void findPtrCandidates32(const BYTE *data, size_t count, const range32 *ranges, size_t rangeCount, __out qvector<UINT> &indexes);
+
+	// Type name search over 'size' bytes at 'data'.
+	// Outputs the byte offset of every ".?AV" (class) and ".?AU" (struct) type descriptor name prefix.
+	// 'data' must be readable for (size + 3) bytes.
+	void findTypeNames(const BYTE *data, size_t size, __out qvector<UINT> &offsets);
+
+	// Length of the run of plain mangled name chars [A-Za-z0-9_@?$] at 'str'; up to the terminator if
+	// that's all there is, else up to the first other char.
+	// 'str' must be readable for 'size' bytes.
+	size_t spanNameChars(LPCSTR str, size_t size);
+}
@@ -0,0 +1,273 @@
+
+// ****************************************************************************
+// File: TypeName.cpp
+// Desc: MSVC type descriptor name support
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "TypeName.h"
+#include "Simd.h"
+
+// Deepest template argument nesting followed before giving up
+static const int MAX_DEPTH = 32;
+// Most names a back reference table holds
+static const int MAX_NAMES = 10;
+
+// Back reference table, the distinct fragments in the order they were first seen
+struct NAMES
+{
+	LPCSTR at[MAX_NAMES];
+	size_t len[MAX_NAMES];
+	int count;
+};
+
+// Parse state, a recursive descent over the encoding with no allocation
+struct PARSER
+{
+	LPCSTR p;
+	int depth;
+	NAMES *names;	// Names a back reference can refer to in the current template scope
+};
+
+static TypeName::RESULT parseType(PARSER &ps);
+
+// Add a fragment to the back reference table, unless it's already there, same as the demangler does
+static void memorize(NAMES &names, LPCSTR at, size_t len)
+{
+	for (int i = 0; i < names.count; i++)
+	{
+		if ((names.len[i] == len) && (memcmp(names.at[i], at, len) == 0))
+			return;
+	}
+	if (names.count < MAX_NAMES)
+	{
+		names.at[names.count] = at;
+		names.len[names.count] = len;
+		names.count++;
+	}
+}
+
+// Name fragment up to and including its '@'
+static TypeName::RESULT parseIdentifier(PARSER &ps)
+{
+	LPCSTR start = ps.p;
+	while (*ps.p && (*ps.p != '@'))
+		ps.p++;
+	if (!*ps.p)
+		return(TypeName::NOT_NAME);
+	if (ps.p == start)
+		return(TypeName::NOT_NAME);
+	ps.p++;
+	return(TypeName::IS_NAME);
+}
+
+// Template name fragment after the "?$": name '@' then the arguments up to their closing '@'
+static TypeName::RESULT parseTemplate(PARSER &ps)
+{
+	LPCSTR name = ps.p;
+	TypeName::RESULT result = parseIdentifier(ps);
+	if (result != TypeName::IS_NAME)
+		return(result);
+
+	// The arguments get their own back reference scope, starting with the template name
+	if (++ps.depth > MAX_DEPTH)
+		return(TypeName::UNSURE);
+	NAMES inner;
+	inner.count = 0;
+	memorize(inner, name, (size_t) (ps.p - name));
+	NAMES *outerNames = ps.names;
+	ps.names = &inner;
+	while (*ps.p != '@')
+	{
+		if (!*ps.p)
+			return(TypeName::NOT_NAME);
+		result = parseType(ps);
+		if (result != TypeName::IS_NAME)
+			return(result);
+	}
+	ps.p++;
+	ps.depth--;
+	ps.names = outerNames;
+	return(TypeName::IS_NAME);
+}
+
+// Scoped name: fragments, innermost first, up to the closing '@'
+static TypeName::RESULT parseQualifiedName(PARSER &ps)
+{
+	int fragments = 0;
+	for (;;)
+	{
+		LPCSTR at = ps.p;
+		char c = *at;
+		if (c == '@')
+		{
+			ps.p++;
+			return(fragments ? TypeName::IS_NAME : TypeName::NOT_NAME);
+		}
+		else
+		if (c == 0)
+			return(TypeName::NOT_NAME);
+		else
+		// Back reference to an earlier name
+		if ((c >= '0') && (c <= '9'))
+		{
+			if ((c - '0') >= ps.names->count)
+				return(TypeName::UNSURE);
+			ps.p++;
+			fragments++;
+			continue;
+		}
+		else
+		if (c == '?')
+		{
+			TypeName::RESULT result;
+			if (ps.p[1] == '$')
+			{
+				ps.p += 2;
+				result = parseTemplate(ps);
+			}
+			else
+			// Anonymous namespace "?A0x12345678@"
+			if ((ps.p[1] == 'A') && (ps.p[2] == '0') && (ps.p[3] == 'x'))
+			{
+				ps.p += 4;
+				result = parseIdentifier(ps);
+			}
+			else
+				return(TypeName::UNSURE);
+
+			if (result != TypeName::IS_NAME)
+				return(result);
+		}
+		else
+		{
+			TypeName::RESULT result = parseIdentifier(ps);
+			if (result != TypeName::IS_NAME)
+				return(result);
+		}
+		fragments++;
+		memorize(*ps.names, at, (size_t) (ps.p - at));
+	}
+}
+
+// Encoded number: '0'..'9' for 1..10, else hex as 'A'..'P' digits and a '@'; '?' prefix for negatives
+static TypeName::RESULT parseNumber(PARSER &ps)
+{
+	if (*ps.p == '?')
+		ps.p++;
+	if ((*ps.p >= '0') && (*ps.p <= '9'))
+	{
+		ps.p++;
+		return(TypeName::IS_NAME);
+	}
+
+	LPCSTR start = ps.p;
+	while ((*ps.p >= 'A') && (*ps.p <= 'P'))
+		ps.p++;
+	if (*ps.p != '@')
+		return(*ps.p ? TypeName::UNSURE : TypeName::NOT_NAME);
+	ps.p++;
+	return((ps.p > (start + 1)) ? TypeName::IS_NAME : TypeName::UNSURE);
+}
+
+// A type, as a template argument or the whole name
+static TypeName::RESULT parseType(PARSER &ps)
+{
+	char c = *ps.p;
+	switch (c)
+	{
+		// Basic types, signed char through long double, and void
+		case 'C': case 'D': case 'E': case 'F': case 'G': case 'H':
+		case 'I': case 'J': case 'K': case 'M': case 'N': case 'O':
+		case 'X':
+		ps.p++;
+		return(TypeName::IS_NAME);
+
+		// Extended basic types: __int64, bool, wchar_t, char16_t, etc.
+		case '_':
+		switch (ps.p[1])
+		{
+			case 'D': case 'E': case 'F': case 'G': case 'H': case 'I':
+			case 'J': case 'K': case 'L': case 'M': case 'N': case 'S':
+			case 'U': case 'W':
+			ps.p += 2;
+			return(TypeName::IS_NAME);
+		};
+		return(ps.p[1] ? TypeName::UNSURE : TypeName::NOT_NAME);
+
+		// class, struct, union
+		case 'V': case 'U': case 'T':
+		ps.p++;
+		return(parseQualifiedName(ps));
+
+		// enum
+		case 'W':
+		if (ps.p[1] != '4')
+			return(ps.p[1] ? TypeName::UNSURE : TypeName::NOT_NAME);
+		ps.p += 2;
+		return(parseQualifiedName(ps));
+
+		// Pointers and references: optional __ptr64, then the cv class, then the type
+		case 'P': case 'Q': case 'R': case 'S': case 'A': case 'B':
+		ps.p++;
+		if (*ps.p == 'E')
+			ps.p++;
+		if ((*ps.p < 'A') || (*ps.p > 'D'))
+			return(*ps.p ? TypeName::UNSURE : TypeName::NOT_NAME);
+		ps.p++;
+		if (++ps.depth > MAX_DEPTH)
+			return(TypeName::UNSURE);
+		{
+			TypeName::RESULT result = parseType(ps);
+			ps.depth--;
+			return(result);
+		}
+
+		// Template argument back reference
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+		ps.p++;
+		return(TypeName::IS_NAME);
+
+		// Integer constant template argument
+		case '$':
+		if (ps.p[1] == '0')
+		{
+			ps.p += 2;
+			return(parseNumber(ps));
+		}
+		return(ps.p[1] ? TypeName::UNSURE : TypeName::NOT_NAME);
+
+		case 0:
+		return(TypeName::NOT_NAME);
+	};
+
+	return(TypeName::UNSURE);
+}
+
+TypeName::RESULT TypeName::recognize(LPCSTR name, size_t size)
+{
+	// Only the plain encoding chars up to the terminator, else let the demangler look at it
+	size_t len = Simd::spanNameChars(name, size);
+	if ((len >= size) || (name[len] != 0))
+		return(UNSURE);
+	if (len == 0)
+		return(NOT_NAME);
+
+	// "?A" then the class, struct, union or enum type, else a plain type like "H" or "PAD"
+	NAMES names;
+	names.count = 0;
+	PARSER ps = { name, 0, &names };
+	if ((name[0] == '?') && (name[1] == 'A'))
+	{
+		if ((name[2] != 'V') && (name[2] != 'U') && (name[2] != 'T') && (name[2] != 'W'))
+			return(UNSURE);
+		ps.p += 2;
+	}
+	RESULT result = parseType(ps);
+
+	// Has to be the whole string
+	if ((result == IS_NAME) && (*ps.p != 0))
+		return(UNSURE);
+	return(result);
+}
@@ -0,0 +1,23 @@
+
+// ****************************************************************************
+// File: TypeName.h
+// Desc: MSVC type descriptor name support
+//
+// ****************************************************************************
+#pragma once
+
+namespace TypeName
+{
+	enum RESULT
+	{
+		NOT_NAME,	// Can't be a type name
+		IS_NAME,	// Well formed type name
+		UNSURE		// Uses encoding the recognizer doesn't cover, needs the full demangler
+	};
+
+	// Allocation free check of a type descriptor name, less the leading '.', like "?AVfoo@bar@@".
+	// Covers the .?AV/.?AU/.?AT/.?AW4 class forms with namespaces, back references, anonymous namespaces
+	// and the common template arguments, plus the plain basic type forms.
+	// 'name' must be readable for 'size' bytes.
+	RESULT recognize(LPCSTR name, size_t size);
+}
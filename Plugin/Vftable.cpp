@@ -8,6 +8,11 @@
 #include "Main.h"
 #include "Vftable.h"
 #include "RTTI.h"
+#include "RefIndex.h"
+#include "AddrIndex.h"
+#include "SegCache.h"
+#include "PeInfo.h"
+#include <algorithm>
 
 /*
 namespace vftable
@@ -16,6 +21,20 @@ namespace vftable
 };
 */
 
+// Sorted COL pointer slots
+static qvector<ea_t> colSlots;
+
+void vftable::setColSlots(__inout qvector<ea_t> &slots)
+{
+	colSlots.swap(slots);
+	std::sort(colSlots.begin(), colSlots.end());
+}
+
+void vftable::clearColSlots()
+{
+	colSlots.clear();
+}
+
 // Attempt to get information of and fix vftable at address
 // Return TRUE along with info if valid vftable parsed at address
 BOOL vftable::getTableInfo(ea_t ea, vtinfo &info)
@@ -24,7 +43,7 @@ BOOL vftable::getTableInfo(ea_t ea, vtinfo &info)
     // Ideal flags 32bit: FF_DWRD, FF_0OFF, FF_REF, FF_NAME, FF_DATA, FF_IVL
     //dumpFlags(ea);
     flags_t flags = get_flags(ea);
-	if(has_xref(flags) && has_any_name(flags) && (isEa(flags) || is_unknown(flags)))
+	if((has_xref(flags) || RefIndex::isPointedTo(ea)) && has_any_name(flags) && (isEa(flags) || is_unknown(flags)))
     {
 		ZeroMemory(&info, sizeof(vtinfo));
 
@@ -34,20 +53,27 @@ BOOL vftable::getTableInfo(ea_t ea, vtinfo &info)
 
         // Determine the vft's method count
         ea_t start = info.start = ea;
-        while (TRUE)
+
+        // Up to the next vftable's COL pointer at most
+        ea_t limit = BADADDR;
+        qvector<ea_t>::const_iterator next = std::upper_bound(colSlots.begin(), colSlots.end(), start);
+        if (next != colSlots.end())
+            limit = *next;
+
+        while (ea < limit)
         {
             // Should be an ea_t sized offset to a function here (could be unknown if dirty IDB)
             // Ideal flags for 32bit: FF_DWRD, FF_0OFF, FF_REF, FF_NAME, FF_DATA, FF_IVL
             //dumpFlags(ea);
-            flags_t indexFlags = get_flags(ea);
-            if (!(isEa(indexFlags) || is_unknown(indexFlags)))
+            BYTE slot = AddrIndex::getSlot(ea);
+            if (!(slot & AddrIndex::SLOT_EA))
             {
                 //msg(" ******* 1\n");
                 break;
             }
 
             // Look at what this (assumed vftable index) points too
-            ea_t memberPtr = getEa(ea);
+            ea_t memberPtr = SegCache::getEa(ea);
             if (!(memberPtr && (memberPtr != BADADDR)))
             {
                 // vft's often have a trailing zero ea_t (alignment, or?), fix it
@@ -58,48 +84,44 @@ BOOL vftable::getTableInfo(ea_t ea, vtinfo &info)
                 break;
             }
 
-            // Should see code for a good vft method here, but it could be dirty
-            flags_t flags = get_flags(memberPtr);
-            if (!(is_code(flags) || is_unknown(flags)))
+            // A function start in the PE function tables needs no more checks
+            PeInfo::RESULT known = PeInfo::checkFunction(memberPtr);
+
+            // Should see code for a good vft method here, but it could be dirty.
+            // New for version 2.5: there are rare cases where IDA hasn't fix unresolved bytes,
+            // so accept any member pointer into a code segment. Checked first as it's the common case.
+            if ((known == PeInfo::UNSURE) && !AddrIndex::isCode(memberPtr))
             {
-				// New for version 2.5: there are rare cases where IDA hasn't fix unresolved bytes
-				// So except if the member pointer is in a code segment as a 2nd chance
-				if (segment_t *s = getseg(memberPtr))
-				{
-					if (s->type != SEG_CODE)
-					{
-						//msg(" ******* 3\n");
-						break;
-					}
-				}
-				else
-				{
-					//msg(" ******* 3.5\n");
-					break;
-				}
+                flags_t flags = get_flags(memberPtr);
+                if (!(is_code(flags) || is_unknown(flags)))
+                {
+                    //msg(" ******* 3\n");
+                    break;
+                }
             }
 
 
             if (ea != start)
             {
-                // If we see a ref after first index it's probably the beginning of the next vft or something else
-                if (has_xref(indexFlags))
+                // If we see a ref after first index it's probably the beginning of the next vft or something else.
+                // The index catches data pointers IDA's analysis missed.
+                if ((slot & AddrIndex::SLOT_XREF) || RefIndex::isPointedTo(ea))
                 {
                     //msg(" ******* 4\n");
                     break;
                 }
 
-                // If we see a COL here it must be the start of another vftable
-                if (RTTI::_RTTICompleteObjectLocator::isValid(memberPtr))
+                // Without the boundaries, if we see a COL here it must be the start of another vftable
+                if (colSlots.empty() && RTTI::_RTTICompleteObjectLocator::isValid(memberPtr))
                 {
                     //msg(" ******* 5\n");
                     break;
                 }
             }
 
-            // As needed fix ea_t pointer, and, or, missing code and function def here
+            // As needed fix ea_t pointer, the missing code and function defs get done in one batch later
             fixEa(ea);
-            fixFunction(memberPtr);
+            addMethod(memberPtr);
 
             ea += sizeof(ea_t);
         };
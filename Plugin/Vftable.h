@@ -18,6 +18,11 @@ namespace vftable
 
 	BOOL getTableInfo(ea_t ea, vtinfo &info);
 
+	// Vftable boundaries: every slot holding a COL pointer, the one right above each vftable.
+	// While set, a vftable ends at the next one instead of every member being validated as a possible COL.
+	void setColSlots(__inout qvector<ea_t> &slots);
+	void clearColSlots();
+
 	// Returns TRUE if mangled name indicates a vftable
 	inline BOOL isValid(LPCSTR name){ return(*((PDWORD) name) == 0x375F3F3F /*"??_7"*/); }
 
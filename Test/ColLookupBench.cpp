@@ -0,0 +1,94 @@
+// ****************************************************************************
+// File: ColLookupBench.cpp
+// Desc: refTable against the hash set it replaced for the vftable scan's COL lookups
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "RefTable.h"
+
+// Lookups per table size, about what a large image's data segments give the vftable scan
+static const size_t PROBE_COUNT = (4 * 1024 * 1024);
+// Where the synthetic image sits and how big it is
+static const ea_t IMAGE_BASE = (ea_t) 0x140000000ULL;
+static const ea_t IMAGE_SIZE = (ea_t) 0x10000000;
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+// One run at 'colCount' COLs. Returns FALSE if the two structures disagree.
+static BOOL run(size_t colCount, std::mt19937_64 &random)
+{
+	// COLs packed into an .rdata like run in the middle of the image, 24 to 280 bytes apart
+	eaList list;
+	ea_t ea = (IMAGE_BASE + (IMAGE_SIZE / 4));
+	for (size_t i = 0; i < colCount; i++)
+	{
+		ea += (ea_t) (24 + ((random() % 32) * 8));
+		list.push_back(ea);
+	}
+	ea_t colEnd = ea;
+
+	refTable table;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	table.build(list);
+	double tableBuild = elapsedMs(start);
+
+	eaSet set;
+	start = std::chrono::steady_clock::now();
+	for (eaList::const_iterator it = list.begin(); it != list.end(); ++it)
+		set.insert(*it);
+	double setBuild = elapsedMs(start);
+
+	// Scan slot values: mostly zeros and small integers, then pointers anywhere in the image,
+	// pointers near the COLs, and a few real COL pointers
+	qvector<ea_t> probes;
+	probes.resize(PROBE_COUNT);
+	for (size_t i = 0; i < PROBE_COUNT; i++)
+	{
+		UINT kind = (UINT) (random() % 100);
+		if (kind < 45)
+			probes[i] = (ea_t) (random() % 0x10000);
+		else
+		if (kind < 80)
+			probes[i] = (IMAGE_BASE + ((ea_t) (random() % IMAGE_SIZE) & ~(ea_t) 7));
+		else
+		if (kind < 97)
+			probes[i] = ((IMAGE_BASE + (IMAGE_SIZE / 4)) + ((ea_t) (random() % (colEnd - (IMAGE_BASE + (IMAGE_SIZE / 4)))) & ~(ea_t) 7));
+		else
+			probes[i] = table.getEa((size_t) (random() % colCount));
+	}
+
+	size_t tableHits = 0, setHits = 0;
+	start = std::chrono::steady_clock::now();
+	for (qvector<ea_t>::const_iterator it = probes.begin(), end = probes.end(); it != end; ++it)
+		tableHits += (size_t) (table.find(*it) >= 0);
+	double tableTime = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	for (qvector<ea_t>::const_iterator it = probes.begin(), end = probes.end(); it != end; ++it)
+		setHits += set.count(*it);
+	double setTime = elapsedMs(start);
+
+	printf("%9u COLs: ref table %8.2f ms (%5.2f ns/lookup, build %7.2f ms), hash set %8.2f ms (%5.2f ns/lookup, build %7.2f ms), %u hits\n",
+		(UINT) colCount, tableTime, ((tableTime * 1e6) / PROBE_COUNT), tableBuild, setTime, ((setTime * 1e6) / PROBE_COUNT), setBuild, (UINT) tableHits);
+
+	if (tableHits != setHits)
+	{
+		printf("FAIL: ref table %u hits, hash set %u hits\n", (UINT) tableHits, (UINT) setHits);
+		return(FALSE);
+	}
+	return(TRUE);
+}
+
+int main()
+{
+	std::mt19937_64 random(0x436C617373496E66ULL);
+	static const size_t counts[] = { 10000, 100000, 1000000 };
+
+	BOOL ok = TRUE;
+	for (size_t i = 0; i < (sizeof(counts) / sizeof(counts[0])); i++)
+		ok &= run(counts[i], random);
+	return(ok ? 0 : 1);
+}
@@ -0,0 +1,142 @@
+// ****************************************************************************
+// File: DemangleTest.cpp
+// Desc: Demangle::typeName() against recorded __unDName() output
+//
+// ****************************************************************************
+#include "Demangle.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <chrono>
+
+// Type descriptor name, less the leading '.', and what __unDName() gives for it with
+// (UNDNAME_32_BIT_DECODE | UNDNAME_TYPE_ONLY | UNDNAME_NO_ECSU).
+// NULL for the encoding left to the CRT, Demangle::typeName() must return zero for those.
+struct TESTCASE
+{
+	const char *mangled;
+	const char *expected;
+};
+
+static const TESTCASE cases[] =
+{
+	// Scoped names
+	{ "?AVtype_info@@",                                 "type_info" },
+	{ "?AUfoo@@",                                       "foo" },
+	{ "?ATbits@@",                                      "bits" },
+	{ "?AW4Color@@",                                    "Color" },
+	{ "?AVbad_alloc@std@@",                             "std::bad_alloc" },
+	{ "?AVinner@middle@outer@@",                        "outer::middle::inner" },
+
+	// Back references
+	{ "?AVfoo@bar@1@",                                  "bar::bar::foo" },
+	{ "?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@", "std::basic_string<char,std::char_traits<char>,std::allocator<char> >" },
+	{ "?AV?$basic_ostream@_WU?$char_traits@_W@std@@@std@@", "std::basic_ostream<wchar_t,std::char_traits<wchar_t> >" },
+	{ "?AV?$foo@V?$bar@H@@V1@@@",                       "foo<bar<int>,bar<int> >" },
+	{ "?AV?$foo@Vx@ns@@Vy@2@Vz@1@@@",                  "foo<ns::x,ns::y,x::z>" },
+
+	// Anonymous namespaces
+	{ "?AVfoo@?A0x1a2b3c4d@@",                          "`anonymous namespace'::foo" },
+	{ "?AUbar@?A0x1a2b3c4d@ns@@",                       "ns::`anonymous namespace'::bar" },
+
+	// Templates
+	{ "?AV?$vector@HV?$allocator@H@std@@@std@@",        "std::vector<int,std::allocator<int> >" },
+	{ "?AV?$foo@V?$bar@H@@@@",                          "foo<bar<int> >" },
+	{ "?AU?$pair@_N_J@std@@",                           "std::pair<bool,__int64>" },
+	{ "?AV?$foo@W4Color@@@@",                           "foo<Color>" },
+
+	// cv-qualified pointers and references
+	{ "?AV?$foo@PAD@@",                                 "foo<char *>" },
+	{ "?AV?$foo@PBD@@",                                 "foo<char const *>" },
+	{ "?AV?$foo@PCH@@",                                 "foo<int volatile *>" },
+	{ "?AV?$foo@QBD@@",                                 "foo<char const * const>" },
+	{ "?AV?$foo@PAPBD@@",                               "foo<char const * *>" },
+	{ "?AV?$foo@ABVbar@@@@",                            "foo<bar const &>" },
+
+	// $0 numbers
+	{ "?AV?$foo@$0A@@@",                                "foo<0>" },
+	{ "?AV?$foo@$00@@",                                 "foo<1>" },
+	{ "?AV?$foo@$09@@",                                 "foo<10>" },
+	{ "?AV?$foo@$0BA@@@",                               "foo<16>" },
+	{ "?AV?$foo@$0?0@@",                                "foo<-1>" },
+	{ "?AV?$foo@H$0IAAA@@@",                            "foo<int,32768>" },
+
+	// Plain types
+	{ "H",                                              "int" },
+	{ "PAD",                                            "char *" },
+
+	// Left to the CRT
+	{ "?AV?$foo@PEAD@@",                                NULL },
+	{ "?AV<lambda_1>@?0??main@@YAHXZ@",                NULL },
+	{ "?AVfoo@1@",                                      NULL },
+	{ "?AVfoo",                                         NULL },
+};
+
+int main()
+{
+	int failed = 0;
+	for (size_t i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++)
+	{
+		const TESTCASE &tc = cases[i];
+		char out[512];
+		size_t len = Demangle::typeName(tc.mangled, out, sizeof(out));
+
+		bool pass;
+		if (tc.expected)
+			pass = ((len == strlen(tc.expected)) && (strcmp(out, tc.expected) == 0));
+		else
+			pass = (len == 0);
+
+		if (!pass)
+		{
+			printf("FAIL: \"%s\" -> \"%s\", expected \"%s\"\n", tc.mangled, (len ? out : "(none)"), (tc.expected ? tc.expected : "(none)"));
+			failed++;
+		}
+	}
+
+	// Output that doesn't fit is a failure, not a truncation
+	char small[8];
+	if (Demangle::typeName("?AVbad_alloc@std@@", small, sizeof(small)) != 0)
+	{
+		printf("FAIL: overflow not detected\n");
+		failed++;
+	}
+
+	// Templates nested to the depth limit, each level a scoped name, in linear time
+	std::string deep = "?AV";
+	std::string deepExpected;
+	for (int i = 0; i < 32; i++)
+	{
+		deep += (i ? "V?$a@" : "?$a@");
+		deepExpected += "ns::a<";
+	}
+	deep += "H";
+	deepExpected += "int";
+	for (int i = 0; i < 32; i++)
+	{
+		deep += "@ns@@";
+		deepExpected += (i ? " >" : ">");
+	}
+	{
+		char out[1024];
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		size_t len = 0;
+		for (int i = 0; i < 1000; i++)
+			len = Demangle::typeName(deep.c_str(), out, sizeof(out));
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if ((len == 0) || (deepExpected != out))
+		{
+			printf("FAIL: depth 32 -> \"%s\"\n", (len ? out : "(none)"));
+			failed++;
+		}
+		else
+		if (ms > 1000.0)
+		{
+			printf("FAIL: depth 32, 1000 runs took %.1f ms\n", ms);
+			failed++;
+		}
+	}
+
+	printf("%d of %d failed\n", failed, (int) ((sizeof(cases) / sizeof(cases[0])) + 2));
+	return(failed ? 1 : 0);
+}
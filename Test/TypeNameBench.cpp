@@ -0,0 +1,105 @@
+// ****************************************************************************
+// File: TypeNameBench.cpp
+// Desc: TypeName::recognize() against full undecoration for the type descriptor name check
+//
+// ****************************************************************************
+#include "stdafx.h"
+#include "TypeName.h"
+#include "Demangle.h"
+#ifdef _WIN32
+#include "undname.h"
+#endif
+
+// Same slot size type_info::isTypeName() reads a name into
+static const size_t MAXSTR = 1024;
+static const size_t NAME_COUNT = 2048;
+static const int PASSES = 20;
+
+// Typical type descriptor names, less the leading '.'
+static const char *const corpus[] =
+{
+	"?AVtype_info@@",
+	"?AVbad_alloc@std@@",
+	"?AVexception@std@@",
+	"?AVinner@middle@outer@@",
+	"?AVfoo@?A0x1a2b3c4d@@",
+	"?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@",
+	"?AV?$basic_ostream@_WU?$char_traits@_W@std@@@std@@",
+	"?AV?$vector@HV?$allocator@H@std@@@std@@",
+	"?AU?$pair@_N_J@std@@",
+	"?AV?$_Ref_count_obj2@VWidget@ui@@@std@@",
+	"?AV?$_Func_impl_no_alloc@V<lambda_1>@?0??run@Task@@QAEXXZ@X$$V@std@@",
+	"?AV?$foo@PBD@@",
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+int main()
+{
+	// The corpus, plus generated class names in random namespaces, each in its own slot
+	std::mt19937 random(0x54797065);
+	std::vector<char> names(NAME_COUNT * MAXSTR, 0);
+	for (size_t i = 0; i < NAME_COUNT; i++)
+	{
+		std::string name;
+		if (i < (sizeof(corpus) / sizeof(corpus[0])))
+			name = corpus[i];
+		else
+		{
+			// "?AVClass1@ns2@@", or the same as the argument of "?AV?$Holder@...@@"
+			BOOL holder = (random() & 1);
+			name = (holder ? "?AV?$Holder@V" : "?AV");
+			name += "Class" + std::to_string(random() % 10000) + "@";
+			for (UINT j = (random() % 3); j > 0; j--)
+				name += "ns" + std::to_string(random() % 100) + "@";
+			name += (holder ? "@@@" : "@");
+		}
+		memcpy(&names[i * MAXSTR], name.c_str(), (name.size() + 1));
+	}
+
+	size_t recognized = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < PASSES; pass++)
+	{
+		for (size_t i = 0; i < NAME_COUNT; i++)
+			recognized += (size_t) (TypeName::recognize(&names[i * MAXSTR], MAXSTR) == TypeName::IS_NAME);
+	}
+	double recognizeTime = elapsedMs(start);
+
+	size_t demangled = 0;
+	char out[MAXSTR];
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < PASSES; pass++)
+	{
+		for (size_t i = 0; i < NAME_COUNT; i++)
+			demangled += (size_t) (Demangle::typeName(&names[i * MAXSTR], out, sizeof(out)) != 0);
+	}
+	double demangleTime = elapsedMs(start);
+
+	const double calls = ((double) NAME_COUNT * PASSES);
+	printf("%u names x %d: recognizer %7.2f ms (%6.1f ns/name, %u recognized)\n", (UINT) NAME_COUNT, PASSES, recognizeTime, ((recognizeTime * 1e6) / calls), (UINT) (recognized / PASSES));
+	printf("%u names x %d: Demangle   %7.2f ms (%6.1f ns/name, %u demangled)\n", (UINT) NAME_COUNT, PASSES, demangleTime, ((demangleTime * 1e6) / calls), (UINT) (demangled / PASSES));
+
+	#ifdef _WIN32
+	// The CRT undecoration type_info::isTypeName() used before the recognizer
+	size_t undecorated = 0;
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < PASSES; pass++)
+	{
+		for (size_t i = 0; i < NAME_COUNT; i++)
+		{
+			if (LPSTR s = __unDName(NULL, &names[i * MAXSTR], 0, mallocWrap, free, (UNDNAME_32_BIT_DECODE | UNDNAME_TYPE_ONLY)))
+			{
+				undecorated++;
+				free(s);
+			}
+		}
+	}
+	double unDNameTime = elapsedMs(start);
+	printf("%u names x %d: __unDName  %7.2f ms (%6.1f ns/name, %u undecorated)\n", (UINT) NAME_COUNT, PASSES, unDNameTime, ((unDNameTime * 1e6) / calls), (UINT) (undecorated / PASSES));
+	#endif
+	return(0);
+}
@@ -0,0 +1,94 @@
+// ****************************************************************************
+// File: stdafx.h
+// Desc: Stand-in for the plug-in's stdafx.h for the off Windows builds
+//
+// ****************************************************************************
+#pragma once
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Just the types and MSVC intrinsics the self-contained plug-in sources use, no IDA SDK or Qt
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+
+typedef unsigned int UINT;
+typedef unsigned char BYTE;
+typedef int BOOL;
+typedef const char *LPCSTR;
+typedef char *LPSTR;
+#define TRUE  1
+#define FALSE 0
+// The standard headers use these as names, so they all come before
+#define __out
+#define __in
+
+// <cpuid.h> has its own __cpuid() macro and, in newer GCCs, __cpuidex()
+inline void cpuidex(int info[4], int leaf, int subLeaf) { __cpuid_count(leaf, subLeaf, info[0], info[1], info[2], info[3]); }
+#undef __cpuid
+#define __cpuid(info, leaf) cpuidex(info, leaf, 0)
+#define __cpuidex(info, leaf, subLeaf) cpuidex(info, leaf, subLeaf)
+// GCC's _xgetbv() needs -mxsave
+inline unsigned long long xgetbv(unsigned int index)
+{
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+	return(((unsigned long long) edx << 32) | eax);
+}
+#define _xgetbv(index) xgetbv(index)
+inline unsigned char _BitScanForward(unsigned long *index, unsigned int mask)
+{
+	if (!mask)
+		return(0);
+	*index = (unsigned long) __builtin_ctz(mask);
+	return(1);
+}
+#endif
+
+#ifdef __EA64__
+typedef unsigned long long ea_t;
+#else
+typedef unsigned int ea_t;
+#endif
+
+// IDA's qvector iterators are plain pointers, the plug-in code relies on that
+template <class T> class qvector : public std::vector<T>
+{
+public:
+	typedef T *iterator;
+	typedef const T *const_iterator;
+
+	iterator begin() { return(this->data()); }
+	iterator end() { return(this->data() + this->size()); }
+	const_iterator begin() const { return(this->data()); }
+	const_iterator end() const { return(this->data() + this->size()); }
+
+	iterator insert(iterator it, const T &value)
+	{
+		size_t index = (size_t) (it - begin());
+		std::vector<T>::insert((std::vector<T>::begin() + index), value);
+		return(begin() + index);
+	}
+	iterator erase(iterator it)
+	{
+		size_t index = (size_t) (it - begin());
+		std::vector<T>::erase(std::vector<T>::begin() + index);
+		return(begin() + index);
+	}
+};
+
+typedef std::list<ea_t> eaList;
+typedef std::unordered_set<ea_t> eaSet;